@@ -35,8 +35,12 @@ def main(args):
     Args:
         args (argparse.Namespace): Parsed command-line arguments.
     """
+    # Progress is shown in the ManiVault background tasks
+    from mvstudio_core import report_progress
+
     try:
         # Get data from ManiVault
+        report_progress(0.0, "Loading image")
         image_guid      = args.input_image_data_guid
         image_mv_ref    = get_data_from_mv(image_guid)
 
@@ -55,8 +59,10 @@ def main(args):
         image_array     = np.flipud(image_array)
         image_pil       = Image.fromarray(image_array)
 
+        report_progress(0.5, "Writing PNG")
         image_path      = args.export_path
         image_pil.save(image_path)
+        report_progress(1.0, "Done")
 
     except Exception as e:
         print("An error occurred:", e)
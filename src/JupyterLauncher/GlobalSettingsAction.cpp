@@ -14,11 +14,25 @@ GlobalSettingsAction::GlobalSettingsAction(QObject* parent, const plugin::Plugin
     PluginGlobalSettingsGroupAction(parent, pluginFactory),
     _defaultPythonPathAction(this, "Python interpreter", ""),
     _defaultKernelWorkingDirectoryAction(this, "Python working directory", ""),
-    _doNotShowAgainButton(this, "Do not show interpreter path picker on start", false)
+    _doNotShowAgainButton(this, "Do not show interpreter path picker on start", false),
+    _transferBudgetAction(this, "Transfer budget (MB)", 0, 1'048'576, 8'192),
+    _useIpcTransportAction(this, "Use IPC transport for the kernel (Linux)", false),
+    _warmUpModulesAction(this, "Warm-up modules", ""),
+    _numAdditionalKernelsAction(this, "Additional kernels", 0, 8, 0),
+    _scriptsInSubinterpretersAction(this, "Run scripts in subinterpreters", false),
+    _moduleRetentionAction(this, "Keep script modules", { "None", "Allowlist", "Outside script folder" }, "Outside script folder"),
+    _retainedModulesAction(this, "Kept modules", "numpy, scipy, skimage, pandas, PIL")
 {
     _defaultPythonPathAction.setToolTip("A python (.exe on Windows) interpreter for Jupyter Plugin");
     _defaultKernelWorkingDirectoryAction.setToolTip("Working directory for the python notebook");
     _doNotShowAgainButton.setToolTip("Whether to show the interpreter path picker on start of the plugin");
+    _transferBudgetAction.setToolTip("Largest data transfer from ManiVault to python in MB. Larger requests are split into chunks. 0 disables the limit");
+    _useIpcTransportAction.setToolTip("Connect JupyterLab and the kernel through local ipc sockets instead of tcp on localhost. Only available on Linux");
+    _numAdditionalKernelsAction.setToolTip("Kernels next to the main kernel, each with an isolated namespace in its own python subinterpreter. There is no parallelism: the subinterpreters share the GIL, so python code in different kernels does not run at the same time. Modules that do not support subinterpreters, like numpy, cannot be imported in them");
+    _scriptsInSubinterpretersAction.setToolTip("Run scripts with an isolated namespace in fresh python subinterpreters on worker threads, such that scripts do not share state. There is no parallelism: the subinterpreters share the GIL, so python code of different scripts does not run at the same time. Modules that do not support subinterpreters, like numpy, cannot be imported in them");
+    _moduleRetentionAction.setToolTip("Which modules imported by a script stay loaded for the next script: none, the kept modules list, or all that are not located in the folder of the script. Once the notebook is started, this only applies to modules that were not loaded before the script, since cells may use the others. Script globals are always removed");
+    _retainedModulesAction.setToolTip("Comma separated packages that stay loaded between scripts when keeping script modules by allowlist");
+    _warmUpModulesAction.setToolTip("Comma separated python modules, e.g. numpy, pandas, that are imported in the background when the python plugin loads");
 
     const auto pythonFilter = pythonInterpreterFilters();
     _defaultPythonPathAction.setNameFilters(pythonFilter);
@@ -34,7 +48,18 @@ GlobalSettingsAction::GlobalSettingsAction(QObject* parent, const plugin::Plugin
         _defaultPythonPathAction.getPickAction().setDisabled(true);
     }
 
+#ifndef Q_OS_LINUX
+    _useIpcTransportAction.setDisabled(true);
+#endif
+
     addAction(&_defaultPythonPathAction);
     addAction(&_defaultKernelWorkingDirectoryAction);
     addAction(&_doNotShowAgainButton);
+    addAction(&_transferBudgetAction);
+    addAction(&_useIpcTransportAction);
+    addAction(&_warmUpModulesAction);
+    addAction(&_numAdditionalKernelsAction);
+    addAction(&_scriptsInSubinterpretersAction);
+    addAction(&_moduleRetentionAction);
+    addAction(&_retainedModulesAction);
 }
@@ -4,6 +4,9 @@
 
 #include <actions/DirectoryPickerAction.h>
 #include <actions/FilePickerAction.h>
+#include <actions/IntegralAction.h>
+#include <actions/OptionAction.h>
+#include <actions/StringAction.h>
 #include <actions/ToggleAction.h>
 
 namespace mv {
@@ -36,9 +39,23 @@ public: // Action getters
     mv::gui::FilePickerAction& getDefaultPythonPathAction() { return _defaultPythonPathAction; }
     mv::gui::DirectoryPickerAction& getDefaultKernelWorkingDirectoryAction() { return _defaultKernelWorkingDirectoryAction; }
     mv::gui::ToggleAction& getDoNotShowAgainButton() { return _doNotShowAgainButton; }
+    mv::gui::IntegralAction& getTransferBudgetAction() { return _transferBudgetAction; }
+    mv::gui::ToggleAction& getUseIpcTransportAction() { return _useIpcTransportAction; }
+    mv::gui::StringAction& getWarmUpModulesAction() { return _warmUpModulesAction; }
+    mv::gui::IntegralAction& getNumAdditionalKernelsAction() { return _numAdditionalKernelsAction; }
+    mv::gui::ToggleAction& getScriptsInSubinterpretersAction() { return _scriptsInSubinterpretersAction; }
+    mv::gui::OptionAction& getModuleRetentionAction() { return _moduleRetentionAction; }
+    mv::gui::StringAction& getRetainedModulesAction() { return _retainedModulesAction; }
 
 private:
     mv::gui::FilePickerAction           _defaultPythonPathAction;               /** Default python path */
     mv::gui::DirectoryPickerAction      _defaultKernelWorkingDirectoryAction;   /** Default python working directory */
     mv::gui::ToggleAction               _doNotShowAgainButton;                  /** Whether to show the interpreter path picker on start */
+    mv::gui::IntegralAction             _transferBudgetAction;                  /** Maximum size in MB of a single data transfer to python, 0 is unlimited */
+    mv::gui::ToggleAction               _useIpcTransportAction;                 /** Whether the kernel uses ipc instead of tcp sockets (Linux only) */
+    mv::gui::StringAction               _warmUpModulesAction;                   /** Comma separated python modules that are imported in the background on plugin load */
+    mv::gui::IntegralAction             _numAdditionalKernelsAction;            /** Number of kernels in subinterpreters next to the main kernel */
+    mv::gui::ToggleAction               _scriptsInSubinterpretersAction;        /** Whether scripts run in parallel, each in a fresh subinterpreter */
+    mv::gui::OptionAction               _moduleRetentionAction;                 /** Which modules imported by a script are kept for the next one, see JupyterPlugin::ModuleRetention */
+    mv::gui::StringAction               _retainedModulesAction;                 /** Comma separated packages that are kept with the allowlist retention */
 };
\ No newline at end of file
@@ -16,7 +16,9 @@
 #include <util/LearningCenterTutorial.h>
 
 #include <QByteArray>
+#include <QDateTime>
 #include <QDebug>
+#include <QDialog>
 #include <QDir>
 #include <QJsonArray>
 #include <QJsonDocument>
@@ -29,12 +31,16 @@
 #include <QPluginLoader>
 #include <QProcess>
 #include <QStringList>
+#include <QPointer>
 #include <QTemporaryDir>
 #include <QTemporaryFile>
+#include <QTextCursor>
 #include <QThread>
 #include <QUrl>
+#include <QVBoxLayout>
 
 #include <algorithm>
+#include <cstdint>
 #include <iostream>
 
 using namespace mv;
@@ -58,10 +64,26 @@ namespace
         return QDir::cleanPath(applicationDir.path() + pathSuffix);
     }
 
+    QStringList splitModuleList(const QString& modules)
+    {
+        QStringList result;
+        for (const QString& module : modules.split(',', Qt::SkipEmptyParts))
+            if (const QString name = module.trimmed(); !name.isEmpty())
+                result.append(name);
+
+        return result;
+    }
+
 	QString getPluginDependenciesFolder()
 	{
 		return getPluginDependenciesDirectory() + "/JupyterLauncher";
 	}
+
+    // Plugin setting with the cached results of requirements checks, see loadPythonScripts
+    const QString requirementsChecksSetting = "Scripts/RequirementsChecks";
+
+    // Plugin setting with the cached environment probes per interpreter, see initPython
+    const QString environmentProbesSetting = "Python/EnvironmentProbes";
  }
 
 // =============================================================================
@@ -100,6 +122,18 @@ JupyterLauncher::JupyterLauncher(const PluginFactory* factory) :
         mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>(this)->getDoNotShowAgainButton().setChecked(toggled);
         });
 
+    // Connected once, the server process may be started again, see startJupyterServerProcess
+    connect(&_serverProcess, &QProcess::stateChanged, this, &JupyterLauncher::jupyterServerStateChanged);
+    connect(&_serverProcess, &QProcess::errorOccurred, this, &JupyterLauncher::jupyterServerError);
+
+    connect(&_serverProcess, &QProcess::started, this, &JupyterLauncher::jupyterServerStarted);
+    connect(&_serverProcess, &QProcess::finished, this, &JupyterLauncher::jupyterServerFinished);
+
+    connect(Application::current(), &QCoreApplication::aboutToQuit, this, &JupyterLauncher::shutdownJupyterServer);
+
+    // Output is captured line by line as it arrives, the remainder when the server finished
+    connect(&_serverProcess, &QProcess::readyReadStandardOutput, this, [this]() { readServerOutput(); });
+
 }
 
 JupyterLauncher::~JupyterLauncher()
@@ -113,9 +147,30 @@ void JupyterLauncher::init()
 {
 }
 
-bool JupyterLauncher::checkPythonVersion()
+QVariantMap JupyterLauncher::loadEnvironmentProbe(const QString& pythonInterpreterPath) const
+{
+    const QVariantMap probes = getSetting(environmentProbesSetting, QVariantMap()).toMap();
+    const QVariantMap probe  = probes.value(QDir::cleanPath(pythonInterpreterPath)).toMap();
+
+    // a replaced or updated interpreter is probed again
+    if (!isEnvironmentProbeCurrent(probe, pythonInterpreterPath))
+        return {};
+
+    return probe;
+}
+
+void JupyterLauncher::storeEnvironmentProbe(const QString& pythonInterpreterPath, QVariantMap probe)
+{
+    probe["interpreter"] = fileStamp(pythonInterpreterPath);
+
+    QVariantMap probes = getSetting(environmentProbesSetting, QVariantMap()).toMap();
+    probes[QDir::cleanPath(pythonInterpreterPath)] = probe;
+    setSetting(environmentProbesSetting, probes);
+}
+
+bool JupyterLauncher::checkPythonVersion(const QVariantMap& probe)
 {
-    const QString currentInterpreterVersion = getPythonVersion(getPythonInterpreterPath());
+    const QString currentInterpreterVersion = probe["version"].toString();
     const QString currentShortVersion = extractShortVersionNumber(currentInterpreterVersion);
 
     const bool match = (_selectedInterpreterVersion == currentShortVersion);
@@ -156,19 +211,64 @@ bool JupyterLauncher::getShowInterpreterPathDialog()
     return !mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getDoNotShowAgainButton().isChecked();
 }
 
-bool JupyterLauncher::runScriptInKernel(const QString& scriptPath, const QStringList& params)
+qulonglong JupyterLauncher::getTransferBudget()
 {
-    if (!_initializedPythonInterpreters.contains(_selectedInterpreterVersion)) {
-        qWarning() << "JupyterLauncher::runScriptInKernel: version not initialized: " << _selectedInterpreterVersion;
-        return false;
+    const auto budgetMB = mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getTransferBudgetAction().getValue();
+    return static_cast<qulonglong>(budgetMB) * 1024 * 1024;
+}
+
+bool JupyterLauncher::getUseIpcTransport()
+{
+#ifdef Q_OS_LINUX
+    return mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getUseIpcTransportAction().isChecked();
+#else
+    return false;
+#endif
+}
+
+QStringList JupyterLauncher::getWarmUpModules()
+{
+    return splitModuleList(mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getWarmUpModulesAction().getString());
+}
+
+int JupyterLauncher::getModuleRetention()
+{
+    return mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getModuleRetentionAction().getCurrentIndex();
+}
+
+QStringList JupyterLauncher::getRetainedModules()
+{
+    return splitModuleList(mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getRetainedModulesAction().getString());
+}
+
+int JupyterLauncher::getNumAdditionalKernels()
+{
+    return mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getNumAdditionalKernelsAction().getValue();
+}
+
+bool JupyterLauncher::getRunScriptsInSubinterpreters()
+{
+    return mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>("Jupyter Launcher")->getScriptsInSubinterpretersAction().isChecked();
+}
+
+mv::plugin::Plugin* JupyterLauncher::getInterpreterPlugin() const
+{
+    const auto interpreterPlugin = _initializedPythonInterpreters.find(_selectedInterpreterVersion);
+
+    if (interpreterPlugin == _initializedPythonInterpreters.end() || !interpreterPlugin->second) {
+        qWarning() << "JupyterLauncher: version not initialized: " << _selectedInterpreterVersion;
+        return nullptr;
     }
 
-    mv::plugin::Plugin* interpreterPlugin = _initializedPythonInterpreters[_selectedInterpreterVersion];
+    return interpreterPlugin->second;
+}
 
-    if (!interpreterPlugin) {
-        qWarning() << "JupyterLauncher::runScriptInKernel: version not initialized: " << _selectedInterpreterVersion;
+bool JupyterLauncher::runScriptInKernel(const QString& scriptPath, const QStringList& params)
+{
+    mv::plugin::Plugin* interpreterPlugin = getInterpreterPlugin();
+
+    if (!interpreterPlugin)
         return false;
-    }
 
     const bool success = QMetaObject::invokeMethod(
         interpreterPlugin,
@@ -184,9 +284,30 @@ bool JupyterLauncher::runScriptInKernel(const QString& scriptPath, const QString
     return true;
 }
 
-bool JupyterLauncher::ensureMvWheelIsInstalled() const
+bool JupyterLauncher::runScriptBatchInKernel(const QString& scriptPath, const QList<QStringList>& paramsPerRun)
 {
-    const QString pluginVersion = QString::fromStdString(getVersion().getVersionString());
+    mv::plugin::Plugin* interpreterPlugin = getInterpreterPlugin();
+
+    if (!interpreterPlugin)
+        return false;
+
+    const bool success = QMetaObject::invokeMethod(
+        interpreterPlugin,
+        "runScriptBatch",
+        Q_ARG(QString, scriptPath),
+        Q_ARG(QList<QStringList>, paramsPerRun)
+    );
+
+    if (!success) {
+        qWarning() << "Failed to invoke runScriptBatch";
+    }
+
+    return true;
+}
+
+void JupyterLauncher::installMvModules(const std::shared_ptr<PythonInitialization>& init)
+{
+    const QString pluginVersion = init->pluginVersion;
     const QMessageBox::StandardButton reply = QMessageBox::question(
         nullptr, 
         "Python modules missing", 
@@ -194,45 +315,36 @@ bool JupyterLauncher::ensureMvWheelIsInstalled() const
         QMessageBox::Yes | QMessageBox::No, QMessageBox::Yes
     );
 
-    if (reply == QMessageBox::Yes) {
-        const auto pythonInterpreter = getPythonInterpreterPath();
-
-        // Bootstrap the pip installer - does nothing if pip is available
-        // https://docs.python.org/3/library/ensurepip.html
-        if (const auto res = runPythonCommand({ "-m", "ensurepip" }, pythonInterpreter, false);
-			res.result != QProcess::NormalExit) {
-          qWarning() << "Installing pip failed. See logging for more information";
-          return false;
-        }
-
-        // Install the manivault wheels
-        const QString mvWheelPath = QDir::toNativeSeparators(getPluginDependenciesFolder() + "/py/");
-        const QString kernelWheel = mvWheelPath + "mvstudio_kernel-" + pluginVersion + "-py3-none-any.whl";
-        const QString dataWheel = mvWheelPath + "mvstudio_data-" + pluginVersion + "-py3-none-any.whl";
-
-        for (const QString& wheelpath : { kernelWheel , dataWheel }) {
-          qDebug() << "wheel paths: " << wheelpath;
-
-          if (const auto res = runPythonCommand({ "-m", "pip", "install", wheelpath, "--only-binary=:all:" }, pythonInterpreter, true);
-              res.result != QProcess::NormalExit) {
-            qWarning() << "Installing the given package failed. See logging for more information";
-            return false;
-          }
-
-        }
+    if (reply != QMessageBox::Yes) {
+        qDebug() << "Could not install ManiVault JupyterPythonKernel modules";
+        finishPythonInitialization(init, false);
+        return;
+    }
 
-        const QTemporaryDir kernelDir = createKernelDir();
+    // Install the manivault wheels
+    const QString mvWheelPath = QDir::toNativeSeparators(getPluginDependenciesFolder() + "/py/");
+    const QString kernelWheel = mvWheelPath + "mvstudio_kernel-" + pluginVersion + "-py3-none-any.whl";
+    const QString dataWheel = mvWheelPath + "mvstudio_data-" + pluginVersion + "-py3-none-any.whl";
 
-        if (const auto res = runPythonCommand(QStringList({ "-m", "jupyter", "kernelspec", "install", kernelDir.path(), "--user"}), pythonInterpreter, true);
-            res.result != QProcess::NormalExit) {
-            qWarning() << "Installing the ManiVaultStudio Jupyter kernel failed. See logging for more information";
-            return false;
-        }
+    const auto kernelDir = std::make_shared<QTemporaryDir>(createKernelDir());
 
-    } else {
-        return false;
-    }
-    return true;
+    // Each stage depends on the previous one
+    std::vector<PythonStage> stages = {
+        // Bootstrap the pip installer - does nothing if pip is available
+        // https://docs.python.org/3/library/ensurepip.html
+        { "Installing pip", { "-m", "ensurepip" }, "Installing pip failed. See logging for more information" },
+        { "Installing mvstudio.kernel", { "-m", "pip", "install", kernelWheel, "--only-binary=:all:" }, "Installing the given package failed. See logging for more information" },
+        { "Installing mvstudio.data", { "-m", "pip", "install", dataWheel, "--only-binary=:all:" }, "Installing the given package failed. See logging for more information" },
+        { "Installing the ManiVaultStudio Jupyter kernel", { "-m", "jupyter", "kernelspec", "install", kernelDir->path(), "--user" }, "Installing the ManiVaultStudio Jupyter kernel failed. See logging for more information" },
+    };
+
+    runPythonStages(init, std::move(stages), [this, init, kernelDir]() {
+        init->probe["mvstudio"]        = init->pluginVersion;
+        init->probe["site-packages"]   = fileStamp(init->sitePackagesPath);
+        storeEnvironmentProbe(init->pythonInterpreterPath, init->probe);
+
+        loadJupyterPlugin(init);
+        });
 }
 
 void JupyterLauncher::shutdownJupyterServer() const
@@ -291,8 +403,11 @@ void JupyterLauncher::jupyterServerError(const QProcess::ProcessError& error) co
     _serverBackgroundTask->setFinished();
 }
 
-void JupyterLauncher::jupyterServerFinished(const int exitCode, const QProcess::ExitStatus& exitStatus) const
+void JupyterLauncher::jupyterServerFinished(const int exitCode, const QProcess::ExitStatus& exitStatus)
 {
+    // the last lines of the log, e.g. the error that ended the server
+    readServerOutput(/* flush */ true);
+
     switch (exitStatus) {
     case QProcess::NormalExit :
         qDebug() << "Jupyter server exited normally with exitCode " << exitCode ;
@@ -300,6 +415,11 @@ void JupyterLauncher::jupyterServerFinished(const int exitCode, const QProcess::
     default:
         qWarning() << "Jupyter server exited abnormally with exitCode " << exitCode ;
         qWarning() << "With error: " << _serverProcess.errorString();
+
+        // the end of the log usually tells why
+        const QStringList serverLog = getServerLog();
+        for (const QString& line : serverLog.mid(std::max<qsizetype>(0, serverLog.size() - 20)))
+            qWarning().noquote() << line;
     }
     
     _serverBackgroundTask->setFinished();
@@ -317,14 +437,15 @@ void JupyterLauncher::jupyterServerStateChanged(const QProcess::ProcessState& ne
         break;
     case QProcess::Running:
         _serverBackgroundTask->setRunning();
-        _serverBackgroundTask->setProgress(1.0f);
+        _serverBackgroundTask->setProgress(0.3f);
         break;
     }
 }
 
 void JupyterLauncher::jupyterServerStarted() const
 {
-    _serverBackgroundTask->setProgress(1.0f);
+    // the task completes once JupyterLab logs its URL, see addServerLogLine
+    _serverBackgroundTask->setProgressDescription("Waiting for JupyterLab");
 }
 
 void JupyterLauncher::startJupyterServerProcess()
@@ -337,40 +458,96 @@ void JupyterLauncher::startJupyterServerProcess()
     _serverProcess.setProgram(getPythonInterpreterPath());
     _serverProcess.setArguments({ "-m", "jupyter", "lab", "--config", _connectionFilePath });
 
-    connect(&_serverProcess, &QProcess::stateChanged, this, &JupyterLauncher::jupyterServerStateChanged);
-    connect(&_serverProcess, &QProcess::errorOccurred, this, &JupyterLauncher::jupyterServerError);
+    _serverLog.assign(serverLogCapacity, {});
+    _numServerLogLines = 0;
+    _serverUrl.clear();
 
-    connect(&_serverProcess, &QProcess::started, this, &JupyterLauncher::jupyterServerStarted);
-    connect(&_serverProcess, &QProcess::finished, this, &JupyterLauncher::jupyterServerFinished);
+    _serverProcess.start();
+}
 
-    connect(Application::current(), &QCoreApplication::aboutToQuit, this, &JupyterLauncher::shutdownJupyterServer);
+void JupyterLauncher::readServerOutput(const bool flush)
+{
+    while (_serverProcess.canReadLine())
+        addServerLogLine(QString::fromUtf8(_serverProcess.readLine()).trimmed());
 
-    _serverProcess.start();
-    _serverPollTimer = new QTimer(this);
-    _serverPollTimer->setInterval(20); // poll every 20ms
+    if (flush && _serverProcess.bytesAvailable() > 0)
+        addServerLogLine(QString::fromUtf8(_serverProcess.readAll()).trimmed());
+}
 
-    connect(_serverPollTimer, &QTimer::timeout, [this]() { 
-        logProcessOutput(); 
-        });
+void JupyterLauncher::addServerLogLine(const QString& line)
+{
+    if (line.isEmpty() || _serverLog.empty())
+        return;
+
+    _serverLog[_numServerLogLines % _serverLog.size()] = line;
+    _numServerLogLines++;
+
+    if (!_serverBackgroundTask)
+        return;
 
-    _serverPollTimer->start();
+    // JupyterLab logs the URL it serves after "Jupyter Server <version> is running at:"
+    static const QRegularExpression urlExpression(R"((https?://[^\s]+/lab)\S*)");
+
+    if (const auto match = urlExpression.match(line); match.hasMatch() && _serverUrl.isEmpty()) {
+        _serverUrl = match.captured(1);
+        _serverBackgroundTask->setProgress(1.0f);
+        _serverBackgroundTask->setProgressDescription(QString("Running at %1").arg(_serverUrl));
+        qDebug() << "JupyterLab is running at" << _serverUrl;
+    }
+    else if (line.startsWith("[E ") || line.startsWith("[C ")) {
+        // errors and critical messages are shown, the full log is available with showServerLog
+        _serverBackgroundTask->setProgressDescription(line);
+    }
 }
 
-void JupyterLauncher::logProcessOutput()
+QStringList JupyterLauncher::getServerLog() const
 {
-    if (!_serverProcess.canReadLine())
-        return; 
+    QStringList serverLog;
 
-    const auto output = _serverProcess.readAll();
-    _serverBackgroundTask->setProgressDescription(output);
+    const std::uint64_t numLines    = std::min<std::uint64_t>(_numServerLogLines, _serverLog.size());
+    const std::uint64_t first       = _numServerLogLines - numLines;
 
+    for (std::uint64_t i = first; i < _numServerLogLines; ++i)
+        serverLog.append(_serverLog[i % _serverLog.size()]);
+
+    return serverLog;
 }
 
-bool JupyterLauncher::initPython(const bool activateXeus)
+void JupyterLauncher::showServerLog() const
+{
+    auto dialog = new QDialog();
+    dialog->setAttribute(Qt::WA_DeleteOnClose);
+    dialog->setWindowTitle("Jupyter Server log");
+    dialog->setWindowIcon(QIcon(":/images/logo.svg"));
+    dialog->resize(900, 500);
+
+    auto logView = new QPlainTextEdit(dialog);
+    logView->setReadOnly(true);
+    logView->setLineWrapMode(QPlainTextEdit::NoWrap);
+    logView->setPlainText(getServerLog().join("\n"));
+    logView->moveCursor(QTextCursor::End);
+
+    auto layout = new QVBoxLayout(dialog);
+    layout->addWidget(logView);
+
+    dialog->show();
+}
+
+void JupyterLauncher::initPython(const bool activateXeus, InitializedCallback onInitialized)
 {
     if (_initializedPythonInterpreters.contains(_selectedInterpreterVersion)) {
         qDebug() << "JupyterLauncher::initPython: already initialized: " << _selectedInterpreterVersion;
-        return true;
+        onInitialized(true);
+        return;
+    }
+
+    if (_pythonInitialization) {
+        qDebug() << "JupyterLauncher::initPython: already initializing";
+
+        // only read when the JupyterPlugin is loaded, which ends the initialization
+        _pythonInitialization->activateXeus = _pythonInitialization->activateXeus || activateXeus;
+        _pythonInitialization->onInitialized.push_back(std::move(onInitialized));
+        return;
     }
 
     // Check if the user set a python interpreter path
@@ -379,50 +556,197 @@ bool JupyterLauncher::initPython(const bool activateXeus)
             nullptr,
             "No Python interpreter",
             "Please provide a path to a python interpreter in the plugin settings.\n Go to File -> Settings -> Plugin: Jupyter Launcher -> Python interpreter");
-        return false;
+        onInitialized(false);
+        return;
     }
 
-    if (!checkPythonVersion()) {
+    auto init = std::make_shared<PythonInitialization>();
+    init->activateXeus          = activateXeus;
+    init->onInitialized.push_back(std::move(onInitialized));
+    init->pythonInterpreterPath = getPythonInterpreterPath();
+    init->pluginVersion         = QString::fromStdString(getVersion().getVersionString());
+    init->sitePackagesPath      = getSitePackagesPath(init->pythonInterpreterPath, _selectedInterpreterVersion);
+
+    // Probe results are cached per interpreter, an unchanged environment is not probed again
+    init->probe = loadEnvironmentProbe(init->pythonInterpreterPath);
+
+    init->task = new BackgroundTask(this, "Python environment");
+    init->task->setProgressMode(Task::ProgressMode::Manual);
+    init->task->setRunning();
+
+    _pythonInitialization = init;
+    setLaunchTriggersEnabled(false);
+
+    // The probes run with the environment of the selected interpreter
+    setPythonEnv(init->pythonInterpreterPath, _selectedInterpreterVersion, _connectionFilePath);
+
+    // Independent probes run concurrently, the plugin is loaded when all finished
+    auto onProbed = [this, init](const PythonExecutionReturn&) {
+        if (!init->startingProbes && init->numRunningStages == 0)
+            checkEnvironmentProbes(init);
+        };
+
+    init->startingProbes = true;
+
+    if (init->probe.value("version").toString().isEmpty()) {
+        runPythonStage(init, "Checking Python version", { "--version" }, [init, onProbed](const PythonExecutionReturn& res) {
+            // Some Python versions print to stderr
+            init->probe["version"] = extractVersionNumber(res.out.trimmed().isEmpty() ? res.err.trimmed() : res.out.trimmed());
+            onProbed(res);
+            });
+    }
+
+	// Check the path to see if the correct version of mvstudio is installed, again after packages were installed or removed
+    if (!isMvModulesProbeCurrent(init->probe, init->pluginVersion, init->sitePackagesPath)) {
+        runPythonStage(init, "Checking ManiVault communication modules", {}, [init, onProbed](const PythonExecutionReturn& res) {
+            init->envCheck = res;
+            onProbed(res);
+            }, ":/text/check_env.py", { init->pluginVersion });
+    }
+
+    // Determine the path to the python library
+    if (const QString libPython = init->probe.value("libpython").toString();
+        libPython.isEmpty() || !QFileInfo::exists(QDir::toNativeSeparators(libPython))) {
+        runPythonStage(init, "Locating the Python library", {}, [init, onProbed](const PythonExecutionReturn& res) {
+            if (res.result != QProcess::NormalExit) {
+                qDebug() << "JupyterLauncher::initPython: Finding python library failed";
+                qDebug() << res.out;
+                qDebug() << res.err;
+            }
+            else {
+                init->probe["libpython"] = res.out;
+            }
+            onProbed(res);
+            }, ":/text/find_libpython.py");
+    }
+
+    init->startingProbes = false;
+
+    if (init->numRunningStages == 0)
+        checkEnvironmentProbes(init);
+}
+
+void JupyterLauncher::checkEnvironmentProbes(const std::shared_ptr<PythonInitialization>& init)
+{
+    const bool pythonVersionMatches = checkPythonVersion(init->probe);
+    storeEnvironmentProbe(init->pythonInterpreterPath, init->probe);
+
+    if (!pythonVersionMatches) {
         qDebug() << "The given python interpreter does not match the selected python version";
-        return false;
+        finishPythonInitialization(init, false);
+        return;
     }
 
-    setPythonEnv(getPythonInterpreterPath(), _selectedInterpreterVersion, _connectionFilePath);
+    if (init->probe.value("libpython").toString().isEmpty()) {
+        finishPythonInitialization(init, false);
+        return;
+    }
 
-	// Check the path to see if the correct version of mvstudio is installed
-    const QString pluginVersion = QString::fromStdString(getVersion().getVersionString());
-    const auto pythonResEnv = runPythonScript(":/text/check_env.py", getPythonInterpreterPath(), { pluginVersion });
+    if (init->envCheck) {
+        const PythonExecutionReturn& pythonResEnv = *init->envCheck;
 
-    if (pythonResEnv.result != QProcess::NormalExit) {
-        qDebug() << "JupyterLauncher::createPythonPluginAndStartNotebook: Checking environment failed";
-        qDebug() << pythonResEnv.out;
-        qDebug() << pythonResEnv.err;
+        if (pythonResEnv.result != QProcess::NormalExit) {
+            qDebug() << "JupyterLauncher::initPython: Checking environment failed";
+            qDebug() << pythonResEnv.out;
+            qDebug() << pythonResEnv.err;
 
-        // error like time out or other failed connection
-        if (pythonResEnv.result >= 2)
-            return false;
+            // error like time out or other failed connection
+            if (pythonResEnv.result >= 2) {
+                finishPythonInitialization(init, false);
+                return;
+            }
 
-        // we might just miss the communication modules
-        if (pythonResEnv.result == QProcess::CrashExit)
-        {
-            if (!ensureMvWheelIsInstalled())
-            {
-                qDebug() << "Could not install ManiVault JupyterPythonKernel modules";
-                return false;
+            // we might just miss the communication modules
+            if (pythonResEnv.result == QProcess::CrashExit) {
+                installMvModules(init);
+                return;
             }
         }
+        else {
+            init->probe["mvstudio"]        = init->pluginVersion;
+            init->probe["site-packages"]   = fileStamp(init->sitePackagesPath);
+            storeEnvironmentProbe(init->pythonInterpreterPath, init->probe);
+        }
     }
 
-    // Determine the path to the python library
-    const auto pythonResLib = runPythonScript(":/text/find_libpython.py", getPythonInterpreterPath());
-    if (pythonResLib.result != QProcess::NormalExit) {
-        qDebug() << "JupyterLauncher::createPythonPluginAndStartNotebook: Finding python library failed";
-        qDebug() << pythonResLib.out;
-        qDebug() << pythonResLib.err;
-        return false;
+    loadJupyterPlugin(init);
+}
+
+void JupyterLauncher::runPythonStage(const std::shared_ptr<PythonInitialization>& init, const QString& description, const QStringList& params, PythonExecutionCallback onFinished, const QString& scriptName, const QStringList& scriptParams)
+{
+    init->numStages++;
+    init->numRunningStages++;
+
+    if (init->task)
+        init->task->setProgressDescription(description);
+
+    auto onStageFinished = [init, onFinished = std::move(onFinished)](const PythonExecutionReturn& res) {
+        init->numRunningStages--;
+        init->numFinishedStages++;
+
+        if (init->task)
+            init->task->setProgress(static_cast<float>(init->numFinishedStages) / static_cast<float>(init->numStages));
+
+        onFinished(res);
+        };
+
+    if (scriptName.isEmpty())
+        startPythonCommand(params, init->pythonInterpreterPath, this, std::move(onStageFinished), true);
+    else
+        startPythonScript(scriptName, init->pythonInterpreterPath, this, std::move(onStageFinished), scriptParams);
+}
+
+void JupyterLauncher::runPythonStages(const std::shared_ptr<PythonInitialization>& init, std::vector<PythonStage> stages, std::function<void()> onSucceeded)
+{
+    if (stages.empty()) {
+        onSucceeded();
+        return;
+    }
+
+    const PythonStage stage = stages.front();
+    stages.erase(stages.begin());
+
+    runPythonStage(init, stage.description, stage.params, [this, init, stage, stages = std::move(stages), onSucceeded = std::move(onSucceeded)](const PythonExecutionReturn& res) {
+        if (res.result != QProcess::NormalExit) {
+            qWarning() << stage.failureMessage;
+            finishPythonInitialization(init, false);
+            return;
+        }
+
+        runPythonStages(init, stages, onSucceeded);
+        });
+}
+
+void JupyterLauncher::finishPythonInitialization(const std::shared_ptr<PythonInitialization>& init, const bool initialized)
+{
+    if (init->task) {
+        init->task->setFinished();
+        init->task->deleteLater();
     }
 
-    const auto pythonLibrary = QFileInfo(QDir::toNativeSeparators(pythonResLib.out));
+    if (_pythonInitialization == init)
+        _pythonInitialization.reset();
+
+    if (!initialized)
+        setLaunchTriggersEnabled(true);
+
+    // a callback may start another initialization
+    const std::vector<InitializedCallback> onInitialized = std::move(init->onInitialized);
+    for (const auto& callback : onInitialized)
+        callback(initialized);
+}
+
+void JupyterLauncher::loadJupyterPlugin(const std::shared_ptr<PythonInitialization>& init)
+{
+    if (init->task)
+        init->task->setProgressDescription("Loading the JupyterPlugin");
+
+    finishPythonInitialization(init, createJupyterPlugin(init->activateXeus, init->probe["libpython"].toString()));
+}
+
+bool JupyterLauncher::createJupyterPlugin(const bool activateXeus, const QString& libPythonPath)
+{
+    const auto pythonLibrary = QFileInfo(QDir::toNativeSeparators(libPythonPath));
 
     qDebug() << "Using python communication plugin library " << pythonLibrary.fileName() << " at: " << pythonLibrary.dir().absolutePath();
     if (!loadDynamicLibrary(pythonLibrary)) {
@@ -483,6 +807,73 @@ bool JupyterLauncher::initPython(const bool activateXeus)
         qWarning() << "Failed to invoke JupyterPlugin::setNotebookWorkingDir";
     }
 
+    const bool setTransferBudget = QMetaObject::invokeMethod(
+        jupyterPluginInstance,
+        "setTransferBudget",
+        Q_ARG(qulonglong, getTransferBudget())
+    );
+
+    if (!setTransferBudget) {
+        qWarning() << "Failed to invoke JupyterPlugin::setTransferBudget";
+    }
+
+    // A changed budget applies to the next transfer
+    connect(&mv::settings().getPluginGlobalSettingsGroupAction<GlobalSettingsAction>(this)->getTransferBudgetAction(), &mv::gui::IntegralAction::valueChanged, jupyterPluginInstance, [jupyterPluginInstance]() {
+        if (!QMetaObject::invokeMethod(jupyterPluginInstance, "setTransferBudget", Q_ARG(qulonglong, getTransferBudget())))
+            qWarning() << "Failed to invoke JupyterPlugin::setTransferBudget";
+        });
+
+    const bool setUseIpcTransport = QMetaObject::invokeMethod(
+        jupyterPluginInstance,
+        "setUseIpcTransport",
+        Q_ARG(bool, getUseIpcTransport())
+    );
+
+    if (!setUseIpcTransport) {
+        qWarning() << "Failed to invoke JupyterPlugin::setUseIpcTransport";
+    }
+
+    const bool setWarmUpModules = QMetaObject::invokeMethod(
+        jupyterPluginInstance,
+        "setWarmUpModules",
+        Q_ARG(QStringList, getWarmUpModules())
+    );
+
+    if (!setWarmUpModules) {
+        qWarning() << "Failed to invoke JupyterPlugin::setWarmUpModules";
+    }
+
+    const bool setNumAdditionalKernels = QMetaObject::invokeMethod(
+        jupyterPluginInstance,
+        "setNumAdditionalKernels",
+        Q_ARG(int, getNumAdditionalKernels())
+    );
+
+    if (!setNumAdditionalKernels) {
+        qWarning() << "Failed to invoke JupyterPlugin::setNumAdditionalKernels";
+    }
+
+    const bool setRunScriptsInSubinterpreters = QMetaObject::invokeMethod(
+        jupyterPluginInstance,
+        "setRunScriptsInSubinterpreters",
+        Q_ARG(bool, getRunScriptsInSubinterpreters())
+    );
+
+    if (!setRunScriptsInSubinterpreters) {
+        qWarning() << "Failed to invoke JupyterPlugin::setRunScriptsInSubinterpreters";
+    }
+
+    const bool setModuleRetention = QMetaObject::invokeMethod(
+        jupyterPluginInstance,
+        "setModuleRetention",
+        Q_ARG(int, getModuleRetention()),
+        Q_ARG(QStringList, getRetainedModules())
+    );
+
+    if (!setModuleRetention) {
+        qWarning() << "Failed to invoke JupyterPlugin::setModuleRetention";
+    }
+
     jupyterPluginInstance->init();
 
     if (activateXeus) {
@@ -532,12 +923,14 @@ void JupyterLauncher::launchJupyterKernelAndNotebook(const QString& version)
 
 void JupyterLauncher::createPythonPluginAndStartNotebook()
 {
-    if (!initPython(/* activateXeus */ true))
-        return;
+    initPython(/* activateXeus */ true, [this](const bool initialized) {
+        if (!initialized)
+            return;
 
-    startJupyterServerProcess();
+        startJupyterServerProcess();
 
-    setLaunchTriggersEnabled(false);
+        setLaunchTriggersEnabled(false);
+        });
 }
 
 void JupyterLauncher::initPythonScripts(const QString& version)
@@ -550,9 +943,14 @@ void JupyterLauncher::initPythonScripts(const QString& version)
 
 void JupyterLauncher::addPythonScripts()
 {
-    if (!initPython(/* activateXeus */ false))
-        return;
+    initPython(/* activateXeus */ false, [this](const bool initialized) {
+        if (initialized)
+            loadPythonScripts();
+        });
+}
 
+void JupyterLauncher::loadPythonScripts()
+{
     // Look for all available scripts
     const auto jupyterPluginDir = QDir(QCoreApplication::applicationDirPath() + "/examples/JupyterPlugin/scripts");
 
@@ -563,30 +961,20 @@ void JupyterLauncher::addPythonScripts()
         scriptFilePaths.push_back(fileInfo.absoluteFilePath());
     }
 
-    // Add UI entries for the scripts
-    auto checkRequirements = [](const QString& requirementsFilePath) -> bool {
-
-        if (const QFileInfo requirementsFileInfo(requirementsFilePath);
-            !requirementsFileInfo.exists() || !requirementsFileInfo.isFile()) {
-            qDebug() << "Requirements file is listed but not found: " << requirementsFileInfo;
-            return false;
-        }
-
-        const QStringList params = { "-m", "pip", "install", "-r", requirementsFilePath, "--dry-run" };
-
-#ifdef NDEBUG
-        constexpr bool verbose = false;
-#else
-        constexpr bool verbose = true;
-#endif
+    // Results of earlier discoveries no longer apply
+    const std::uint64_t discovery = ++_scriptDiscovery;
+    _queuedRequirementsChecks.clear();
+    _numPendingRequirementsChecks = 0;
+    _scriptTriggerActions.clear();
 
-        const auto res = runPythonCommand(params, getPythonInterpreterPath(), verbose);
+    // Requirements checks are cached per requirements file content, interpreter and state of its site-packages,
+    // such that only new or changed requirements or environments are checked with pip
+    const QString pythonInterpreterPath = getPythonInterpreterPath();
+    const QString sitePackagesPath      = getSitePackagesPath(pythonInterpreterPath, _selectedInterpreterVersion);
+    const qint64 sitePackagesModified   = QFileInfo(sitePackagesPath).lastModified().toMSecsSinceEpoch();
 
-        return res.result == QProcess::NormalExit;
-        };
-
-    uint32_t numLoadedScripts = 0;
-    _scriptTriggerActions.clear();
+    const QVariantMap cachedChecks = getSetting(requirementsChecksSetting, QVariantMap()).toMap();
+    _requirementsChecks.clear();
 
     for (const auto& scriptFilePath : scriptFilePaths) {
         auto scriptFile = QFile(scriptFilePath);
@@ -624,49 +1012,125 @@ void JupyterLauncher::addPythonScripts()
 
         // check requirements
         if (containsMemberString(json, "requirements")) {
-            QString requirementsFilePath = scriptFileDir.filePath(json["requirements"].toString());
+            const QString requirementsFilePath = scriptFileDir.filePath(json["requirements"].toString());
 
-            qDebug() << "Checking and installing requirements for: " << requirementsFilePath;
-            if (!checkRequirements(requirementsFilePath)) {
-                qDebug() << "Requirements are not installed for Python script: " << scriptFilePath;
+            if (const QFileInfo requirementsFileInfo(requirementsFilePath);
+                !requirementsFileInfo.exists() || !requirementsFileInfo.isFile()) {
+                qDebug() << "Requirements file is listed but not found: " << requirementsFileInfo;
                 continue;
             }
 
-        }
+            const QString cacheKey = requirementsCacheKey(requirementsFilePath, pythonInterpreterPath, sitePackagesModified);
 
-        const QString scriptPath = scriptFileDir.filePath(json["script"].toString());
-        const QString scriptName = json["name"].toString();
-        const QString scriptType = json["type"].toString();
+            if (cachedChecks.contains(cacheKey)) {
+                _requirementsChecks.insert(cacheKey, cachedChecks[cacheKey]);
 
-        const QString fullPyVersion = QString("%1.%2").arg(_selectedInterpreterVersion, _currentInterpreterPatchVersion);
+                if (!cachedChecks[cacheKey].toBool())
+                    qDebug() << "Requirements are not installed for Python script: " << scriptFilePath;
+                else
+                    addPythonScript(json, scriptFileDir);
 
-        auto& scriptTriggerAction = _scriptTriggerActions.emplace_back(std::make_shared<PythonScript>(scriptName, mv::util::Script::getTypeEnum(scriptType), fullPyVersion, scriptPath, json, this, nullptr));
+                continue;
+            }
 
-        // check if script contains input-datatypes, convert to mv::DataTypes
-        if (containsMemberArray(json, "input-datatypes")) {
-            const std::vector<QString> dataTypeStrings = readStringArray(json, "input-datatypes");
-            mv::DataTypes dataTypes = {};
+            // the script is added when its check finishes
+            qDebug() << "Checking and installing requirements for: " << requirementsFilePath;
+            _numPendingRequirementsChecks++;
 
-            for (const auto& dataTypeString : dataTypeStrings) {
-                dataTypes.push_back(mv::DataType(dataTypeString));
-            }
+            checkRequirements(requirementsFilePath, [this, discovery, cacheKey, json, scriptFileDir, scriptFilePath](const PythonExecutionReturn& res) {
+                if (discovery != _scriptDiscovery)
+                    return;
+
+                // time outs and failures to start are checked again next time
+                if (res.result < 2) {
+                    _requirementsChecks.insert(cacheKey, res.result == QProcess::NormalExit);
+                    setSetting(requirementsChecksSetting, _requirementsChecks);
+                }
 
-            scriptTriggerAction->setDataTypes(dataTypes);
+                if (res.result == QProcess::NormalExit)
+                    addPythonScript(json, scriptFileDir);
+                else
+                    qDebug() << "Requirements are not installed for Python script: " << scriptFilePath;
+
+                if (--_numPendingRequirementsChecks == 0)
+                    qDebug().noquote() << QString("JupyterLauncher: Loaded %1 scripts").arg(_scriptTriggerActions.size());
+                });
+
+            continue;
         }
 
-        numLoadedScripts++;
+        addPythonScript(json, scriptFileDir);
     }
-    
-    qDebug().noquote() << QString("JupyterLauncher: Loaded %1 scripts").arg(numLoadedScripts);
+
+    // only keep the checks of the current scripts and environment
+    setSetting(requirementsChecksSetting, _requirementsChecks);
+
+    if (_numPendingRequirementsChecks == 0)
+        qDebug().noquote() << QString("JupyterLauncher: Loaded %1 scripts").arg(_scriptTriggerActions.size());
+    else
+        qDebug().noquote() << QString("JupyterLauncher: Loaded %1 scripts, checking the requirements of %2 more").arg(_scriptTriggerActions.size()).arg(_numPendingRequirementsChecks);
 
     setLaunchTriggersEnabled(false);
 }
 
-mv::gui::ScriptTriggerActions JupyterLauncher::getScriptTriggerActions(const mv::Datasets& datasets) const {
+void JupyterLauncher::addPythonScript(const QJsonObject& json, const QDir& scriptFileDir)
+{
+    const QString scriptPath = scriptFileDir.filePath(json["script"].toString());
+    const QString scriptName = json["name"].toString();
+    const QString scriptType = json["type"].toString();
 
-    // Currently, do not show scripts for multi-dataset selection
-    if (datasets.count() > 1)
-        return {};
+    const QString fullPyVersion = QString("%1.%2").arg(_selectedInterpreterVersion, _currentInterpreterPatchVersion);
+
+    auto& scriptTriggerAction = _scriptTriggerActions.emplace_back(std::make_shared<PythonScript>(scriptName, mv::util::Script::getTypeEnum(scriptType), fullPyVersion, scriptPath, json, this, nullptr));
+
+    // check if script contains input-datatypes, convert to mv::DataTypes
+    if (containsMemberArray(json, "input-datatypes")) {
+        const std::vector<QString> dataTypeStrings = readStringArray(json, "input-datatypes");
+        mv::DataTypes dataTypes = {};
+
+        for (const auto& dataTypeString : dataTypeStrings) {
+            dataTypes.push_back(mv::DataType(dataTypeString));
+        }
+
+        scriptTriggerAction->setDataTypes(dataTypes);
+    }
+}
+
+void JupyterLauncher::checkRequirements(const QString& requirementsFilePath, PythonExecutionCallback onChecked)
+{
+    _queuedRequirementsChecks.push_back([this, requirementsFilePath, onChecked = std::move(onChecked)]() {
+        const QStringList params = { "-m", "pip", "install", "-r", requirementsFilePath, "--dry-run" };
+
+#ifdef NDEBUG
+        constexpr bool verbose = false;
+#else
+        constexpr bool verbose = true;
+#endif
+
+        _numRunningRequirementsChecks++;
+
+        startPythonCommand(params, getPythonInterpreterPath(), this, [this, onChecked](const PythonExecutionReturn& res) {
+            _numRunningRequirementsChecks--;
+            onChecked(res);
+            startQueuedRequirementsChecks();
+            }, verbose);
+        });
+
+    startQueuedRequirementsChecks();
+}
+
+void JupyterLauncher::startQueuedRequirementsChecks()
+{
+    const int maxRunningChecks = std::max(1, QThread::idealThreadCount());
+
+    while (_numRunningRequirementsChecks < maxRunningChecks && !_queuedRequirementsChecks.empty()) {
+        auto check = std::move(_queuedRequirementsChecks.front());
+        _queuedRequirementsChecks.pop_front();
+        check();
+    }
+}
+
+mv::gui::ScriptTriggerActions JupyterLauncher::getScriptTriggerActions(const mv::Datasets& datasets) const {
 
     ScriptTriggerActions scriptTriggerActions;
     
@@ -680,21 +1144,27 @@ mv::gui::ScriptTriggerActions JupyterLauncher::getScriptTriggerActions(const mv:
             addScript = true;
         }
         
-        if (datasets.count() > 0) {
+        // Multi-dataset selections are only offered to batch scripts
+        if (datasets.count() == 1 || (datasets.count() > 1 && scriptTriggerAction->isBatch())) {
 
-            const auto inputDataType    = datasets.first()->getDataType();
             const auto scriptDataTypes  = scriptTriggerAction->getDataTypes();
     
             // Add script only if datasets are of same type as input-datatypes
-            if (!scriptDataTypes.isEmpty() && scriptDataTypes.contains(inputDataType)) {
-                addScript = true;
+            if (!scriptDataTypes.isEmpty()) {
+                addScript = std::all_of(datasets.begin(), datasets.end(), [&scriptDataTypes](const auto& dataset) {
+                    return scriptDataTypes.contains(dataset->getDataType());
+                });
             }
 
         }
 
-        if (addScript) {
+        if (!addScript)
+            continue;
+
+        if (datasets.count() > 1)
+            scriptTriggerActions << new ScriptTriggerAction(nullptr, scriptTriggerAction->createBatch(datasets), menuLocation);
+        else
             scriptTriggerActions << new ScriptTriggerAction(nullptr, scriptTriggerAction, menuLocation);
-        }
     }
 
     return scriptTriggerActions;
@@ -836,6 +1306,23 @@ void JupyterLauncherFactory::initialize()
 
     }
 
+    // The server log is only collected into the view on request
+    auto showServerLog = new TriggerAction(this, "Show Jupyter Server log");
+
+    connect(showServerLog, &TriggerAction::triggered, this, [this]() {
+        const std::vector<plugin::Plugin*> openJupyterPlugins = mv::plugins().getPluginsByFactory(this);
+
+        if (openJupyterPlugins.empty()) {
+            qDebug() << "JupyterLauncher: no Jupyter Server was started";
+            return;
+        }
+
+        if (const auto* plugin = dynamic_cast<JupyterLauncher*>(openJupyterPlugins.front()))
+            plugin->showServerLog();
+        });
+
+    _statusBarAction->addMenuAction(showServerLog);
+
     // Assign the status bar action so that it will appear on the main window status bar
     setStatusBarAction(_statusBarAction);
 }
@@ -1,5 +1,6 @@
 #pragma once
 
+#include "PythonUtils.h"
 #include "UserDialogActions.h"
 #include "ScriptDialogAction.h"
 
@@ -11,12 +12,20 @@
 #include <actions/TriggerAction.h>
 #include <actions/PluginStatusBarAction.h>
 
+#include <QDir>
+#include <QJsonObject>
 #include <QOperatingSystemVersion>
+#include <QPointer>
 #include <QProcess>
 #include <QStringList>
 #include <QTimer>
+#include <QVariantMap>
 
+#include <cstdint>
+#include <deque>
+#include <functional>
 #include <memory>
+#include <optional>
 #include <unordered_map>
 #include <vector>
 
@@ -76,29 +85,108 @@ public: // Global settings
 
     static bool getShowInterpreterPathDialog();
 
+    static qulonglong getTransferBudget();     // in bytes
+    static bool getUseIpcTransport();
+    static QStringList getWarmUpModules();
+    static int getNumAdditionalKernels();
+    static bool getRunScriptsInSubinterpreters();
+    static int getModuleRetention();            // index of JupyterPlugin::ModuleRetention
+    static QStringList getRetainedModules();
+
 public: 
     bool runScriptInKernel(const QString& scriptPath, const QStringList& params = {});
 
+    /** Runs the script once per entry of paramsPerRun, as one background task */
+    bool runScriptBatchInKernel(const QString& scriptPath, const QList<QStringList>& paramsPerRun);
+
+    /** The last serverLogCapacity lines of Jupyter Server output, oldest first */
+    QStringList getServerLog() const;
+
+    /** Opens a window with the Jupyter Server log */
+    void showServerLog() const;
+
+    static constexpr std::size_t serverLogCapacity = 1000;
+
 private:
+    mv::plugin::Plugin* getInterpreterPlugin() const;
+
     void jupyterServerError(const QProcess::ProcessError& error) const;
-    void jupyterServerFinished(const int exitCode, const QProcess::ExitStatus& exitStatus) const;
+    void jupyterServerFinished(const int exitCode, const QProcess::ExitStatus& exitStatus);
     void jupyterServerStateChanged(const QProcess::ProcessState& newState) const;
     void jupyterServerStarted() const;
     void shutdownJupyterServer() const;
 
 private:
-    bool ensureMvWheelIsInstalled() const;
+    using InitializedCallback = std::function<void(bool initialized)>;
+
+    /** State of an asynchronous initPython, shared by its stages */
+    struct PythonInitialization
+    {
+        bool                                    activateXeus = false;
+        std::vector<InitializedCallback>        onInitialized = {};         /** Includes those of initPython calls while it runs */
+        QString                                 pythonInterpreterPath = {};
+        QString                                 pluginVersion = {};
+        QString                                 sitePackagesPath = {};
+        QVariantMap                             probe = {};                 /** See loadEnvironmentProbe */
+        std::optional<PythonExecutionReturn>    envCheck = {};              /** Result of check_env.py, if it ran */
+        bool                                    startingProbes = false;
+        int                                     numStages = 0;
+        int                                     numRunningStages = 0;
+        int                                     numFinishedStages = 0;
+        QPointer<mv::BackgroundTask>            task = {};                  /** Reports the stages */
+    };
+
+    struct PythonStage
+    {
+        QString     description;
+        QStringList params;
+        QString     failureMessage;
+    };
+
     bool initLauncher(const QString& version, const int mode);
-    bool initPython(const bool activateXeus = true);
 
-    bool checkPythonVersion();
+    /**
+     * Prepares the python environment and loads the JupyterPlugin without blocking the GUI thread.
+     * Probing the version, the mvstudio modules and libpython run concurrently as python processes,
+     * followed by installing missing modules if needed. onInitialized is called when done, also when
+     * the call finds an initialization running, which then activates xeus if either call asks for it.
+     */
+    void initPython(const bool activateXeus, InitializedCallback onInitialized);
+    void checkEnvironmentProbes(const std::shared_ptr<PythonInitialization>& init);
+    void installMvModules(const std::shared_ptr<PythonInitialization>& init);
+    void loadJupyterPlugin(const std::shared_ptr<PythonInitialization>& init);
+    void finishPythonInitialization(const std::shared_ptr<PythonInitialization>& init, const bool initialized);
+    bool createJupyterPlugin(const bool activateXeus, const QString& libPythonPath);
+
+    /** Runs python with params, or the resource script scriptName with scriptParams, as a stage of init */
+    void runPythonStage(const std::shared_ptr<PythonInitialization>& init, const QString& description, const QStringList& params, PythonExecutionCallback onFinished, const QString& scriptName = {}, const QStringList& scriptParams = {});
+
+    /** Runs the stages one after the other, stops initializing when one fails */
+    void runPythonStages(const std::shared_ptr<PythonInitialization>& init, std::vector<PythonStage> stages, std::function<void()> onSucceeded);
+
+    /** Compares the probed interpreter version with the selected version */
+    bool checkPythonVersion(const QVariantMap& probe);
+
+    /**
+     * Cached results of probing the interpreter: version, mvstudio module version and libpython path.
+     * Valid while the interpreter file keeps its size and modification time.
+     */
+    QVariantMap loadEnvironmentProbe(const QString& pythonInterpreterPath) const;
+    void storeEnvironmentProbe(const QString& pythonInterpreterPath, QVariantMap probe);
 
     void startJupyterServerProcess();
 
-    void logProcessOutput();
+    void readServerOutput(const bool flush = false);
+    void addServerLogLine(const QString& line);
 
     void createPythonPluginAndStartNotebook();
     void addPythonScripts();
+    void loadPythonScripts();
+    void addPythonScript(const QJsonObject& json, const QDir& scriptFileDir);
+
+    /** Runs pip install --dry-run for the requirements, at most one check per core at a time */
+    void checkRequirements(const QString& requirementsFilePath, PythonExecutionCallback onChecked);
+    void startQueuedRequirementsChecks();
 
     void setLaunchTriggersEnabled(bool const enabled) const;
 
@@ -109,13 +197,21 @@ private:
 
     using LoadedPythonInterpreters  = std::unordered_map<QString, mv::plugin::Plugin*>;
     LoadedPythonInterpreters        _initializedPythonInterpreters = {};
+    std::shared_ptr<PythonInitialization> _pythonInitialization = {};  /** Set while initPython runs */
 
     using PythonScripts             = std::vector<std::shared_ptr<PythonScript>>;
     PythonScripts                   _scriptTriggerActions = {};
+    std::uint64_t                   _scriptDiscovery = 0;                   /** Incremented per loadPythonScripts, outdated checks are ignored */
+    QVariantMap                     _requirementsChecks = {};               /** Cached check results by requirementsCacheKey */
+    std::deque<std::function<void()>> _queuedRequirementsChecks = {};
+    int                             _numRunningRequirementsChecks = 0;
+    int                             _numPendingRequirementsChecks = 0;      /** Queued or running checks of the current discovery */
 
     mv::BackgroundTask*             _serverBackgroundTask = nullptr;    /** The background task monitoring the Jupyter Server */
     QProcess                        _serverProcess;                     /** A detached process for running the Jupyter server */
-    QTimer*                         _serverPollTimer = nullptr;         /** Poll the server process output at a regular interval */
+    std::vector<QString>            _serverLog = {};                    /** Ring buffer of the server output lines */
+    std::uint64_t                   _numServerLogLines = 0;
+    QString                         _serverUrl = {};                    /** Parsed from the server output once JupyterLab is ready */
     std::unique_ptr<LauncherDialog> _launcherDialog;
 
 };
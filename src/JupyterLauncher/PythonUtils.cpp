@@ -1,12 +1,20 @@
 #include "PythonUtils.h"
 
+#include <QCryptographicHash>
+#include <QDateTime>
 #include <QDir>
+#include <QFile>
 #include <QFileInfo>
+#include <QObject>
 #include <QProcess>
 #include <QOperatingSystemVersion>
 #include <QRegularExpression>
 #include <QTemporaryDir>
 #include <QTemporaryFile>
+#include <QTimer>
+
+#include <memory>
+#include <utility>
 
 QString extractRegex(const QString& input, const QString& pattern, int group) {
     const QRegularExpression regex(pattern);
@@ -113,6 +121,53 @@ void setPythonEnv(const QString& interpreterPath, const QString& interpreterVers
     qputenv("MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE", connectionFilePath.toUtf8());
 }
 
+QString getSitePackagesPath(const QString& interpreterPath, const QString& interpreterVersion)
+{
+    QString pythonPath = getPythonHomePath(interpreterPath).second;
+
+    if constexpr (QOperatingSystemVersion::currentType() == QOperatingSystemVersion::Windows)
+        return QDir::cleanPath(pythonPath + "/Lib/site-packages");
+
+    if (pythonPath.endsWith("/"))
+        pythonPath = pythonPath.chopped(1);
+
+    return QDir::cleanPath(pythonPath + "/lib/python" + interpreterVersion + "/site-packages");
+}
+
+QString requirementsCacheKey(const QString& requirementsFilePath, const QString& pythonInterpreterPath, qint64 sitePackagesModified)
+{
+    QCryptographicHash hash(QCryptographicHash::Sha256);
+
+    if (QFile requirementsFile(requirementsFilePath); requirementsFile.open(QIODevice::ReadOnly))
+        hash.addData(requirementsFile.readAll());
+
+    hash.addData(QDir::cleanPath(pythonInterpreterPath).toUtf8());
+    hash.addData(QByteArray::number(sitePackagesModified));
+
+    return QString::fromLatin1(hash.result().toHex());
+}
+
+QString fileStamp(const QString& path)
+{
+    const QFileInfo fileInfo(path);
+
+    if (!fileInfo.exists())
+        return {};
+
+    return QString("%1|%2|%3").arg(fileInfo.absoluteFilePath()).arg(fileInfo.size()).arg(fileInfo.lastModified().toMSecsSinceEpoch());
+}
+
+bool isEnvironmentProbeCurrent(const QVariantMap& probe, const QString& pythonInterpreterPath)
+{
+    const QString stamp = fileStamp(pythonInterpreterPath);
+    return !stamp.isEmpty() && probe.value("interpreter").toString() == stamp;
+}
+
+bool isMvModulesProbeCurrent(const QVariantMap& probe, const QString& pluginVersion, const QString& sitePackagesPath)
+{
+    return probe.value("mvstudio").toString() == pluginVersion && probe.value("site-packages").toString() == fileStamp(sitePackagesPath);
+}
+
 std::pair<bool, QString> isCondaEnvironmentActive()
 {
     if (!qEnvironmentVariableIsSet("CONDA_PREFIX"))
@@ -239,3 +294,84 @@ PythonExecutionReturn runPythonScript(const QString& scriptName, const QString&
 
     return runPythonCommand(pythonParams, pythonInterpreterPath, false);
 }
+
+QProcess* startPythonCommand(const QStringList& params, const QString& pythonInterpreterPath, QObject* context, PythonExecutionCallback onFinished, const bool verbose, const int timeoutMSecs)
+{
+    if (verbose) {
+        qDebug() << "Interpreter: " << pythonInterpreterPath;
+        qDebug() << "Command: " << params.join(" ");
+    }
+
+    auto* pythonProcess = new QProcess(context);
+
+    // called once, for whichever of finished, failed to start or timed out comes first
+    auto done   = std::make_shared<bool>(false);
+    auto finish = [pythonProcess, done, verbose, onFinished = std::move(onFinished)](PythonExecutionReturn pythonReturn) {
+        if (*done)
+            return;
+
+        *done = true;
+
+        pythonReturn.out += QString::fromUtf8(pythonProcess->readAllStandardOutput()).replace("\r\n", "\n");
+        pythonReturn.err += QString::fromUtf8(pythonProcess->readAllStandardError()).replace("\r\n", "\n");
+
+        if (verbose) {
+            for (const QString& output : { pythonReturn.out, pythonReturn.err })
+                for (const QString& outline : output.split("\n"))
+                    if (!outline.isEmpty())
+                        qDebug() << outline;
+        }
+
+        if (pythonReturn.result != QProcess::NormalExit)
+            qWarning() << "Failed running script.";
+
+        pythonProcess->deleteLater();
+        onFinished(pythonReturn);
+        };
+
+    QObject::connect(pythonProcess, &QProcess::finished, context, [finish](const int exitCode, const QProcess::ExitStatus exitStatus) {
+        finish({ exitStatus == QProcess::NormalExit ? exitCode : 2 });
+        });
+
+    QObject::connect(pythonProcess, &QProcess::errorOccurred, context, [finish, pythonInterpreterPath](const QProcess::ProcessError error) {
+        if (error == QProcess::FailedToStart)
+            finish({ 2, {}, QString("Could not run python interpreter %1 ").arg(pythonInterpreterPath) });
+        });
+
+    QTimer::singleShot(timeoutMSecs, pythonProcess, [pythonProcess, finish, pythonInterpreterPath]() {
+        finish({ 2, {}, QString("Running python interpreter %1 timed out").arg(pythonInterpreterPath) });
+        pythonProcess->kill();
+        });
+
+    pythonProcess->start(pythonInterpreterPath, params);
+
+    return pythonProcess;
+}
+
+QProcess* startPythonScript(const QString& scriptName, const QString& pythonInterpreterPath, QObject* context, PythonExecutionCallback onFinished, const QStringList& params)
+{
+    qDebug() << "startPythonScript:: Interpreter: " << pythonInterpreterPath;
+    qDebug() << "startPythonScript:: Script: " << scriptName;
+
+    // Place the script in a temporary file, which is removed once the script finished
+    auto scriptFile = QFile(scriptName);
+
+    QByteArray scriptContent;
+    if (scriptFile.open(QFile::ReadOnly)) {
+        scriptContent = scriptFile.readAll();
+        scriptFile.close();
+    }
+
+    auto* tempFile = new QTemporaryFile(context);
+    if (tempFile->open()) {
+        tempFile->write(scriptContent);
+        tempFile->close();
+    }
+
+    const auto pythonParams = QStringList({ tempFile->fileName() }) + params;
+
+    return startPythonCommand(pythonParams, pythonInterpreterPath, context, [tempFile, onFinished = std::move(onFinished)](const PythonExecutionReturn& pythonReturn) {
+        tempFile->deleteLater();
+        onFinished(pythonReturn);
+        });
+}
@@ -3,8 +3,14 @@
 #include <QString>
 #include <QStringList>
 #include <QTemporaryDir>
+#include <QVariantMap>
 #include <QOperatingSystemVersion>
 
+#include <functional>
+
+class QObject;
+class QProcess;
+
 QString extractRegex(const QString& input, const QString& pattern, int group = 1);
 
 inline QString extractVersionNumber(const QString& input) {
@@ -44,6 +50,22 @@ std::pair<bool, QString> getPythonHomePath(const QString& pyInterpreterPath);
 
 void setPythonEnv(const QString& interpreterPath, const QString& interpreterVersion, const QString& connectionFilePath);
 
+// Location of the installed packages, derived from the interpreter path like in setPythonEnv
+QString getSitePackagesPath(const QString& interpreterPath, const QString& interpreterVersion);
+
+// Key of a cached requirements check: changes with the content of the requirements file,
+// the interpreter and the modification time of its site-packages, i.e. when packages are installed
+QString requirementsCacheKey(const QString& requirementsFilePath, const QString& pythonInterpreterPath, qint64 sitePackagesModified);
+
+// Identifies a version of a file or directory by its path, size and modification time, empty if it does not exist
+QString fileStamp(const QString& path);
+
+// A cached environment probe of initPython holds until the interpreter file is replaced or updated
+bool isEnvironmentProbeCurrent(const QVariantMap& probe, const QString& pythonInterpreterPath);
+
+// The probed ManiVault communication modules hold until the plugin version changes or packages are installed or removed
+bool isMvModulesProbeCurrent(const QVariantMap& probe, const QString& pluginVersion, const QString& sitePackagesPath);
+
 std::pair<bool, QString> isCondaEnvironmentActive();
 
 QTemporaryDir createKernelDir();
@@ -52,3 +74,12 @@ PythonExecutionReturn runPythonCommand(const QStringList& params, const QString&
 
 PythonExecutionReturn runPythonScript(const QString& scriptName, const QString& pythonInterpreterPath, const QStringList& params = {}, const bool verbose = false);
 
+using PythonExecutionCallback = std::function<void(const PythonExecutionReturn&)>;
+
+// Asynchronous runPythonCommand: returns right away and calls onFinished in the thread of context
+// when the process finished, failed to start (result 2) or timed out (result 2)
+QProcess* startPythonCommand(const QStringList& params, const QString& pythonInterpreterPath, QObject* context, PythonExecutionCallback onFinished, const bool verbose = false, const int timeoutMSecs = 180'000);
+
+// Asynchronous runPythonScript, see startPythonCommand
+QProcess* startPythonScript(const QString& scriptName, const QString& pythonInterpreterPath, QObject* context, PythonExecutionCallback onFinished, const QStringList& params = {});
+
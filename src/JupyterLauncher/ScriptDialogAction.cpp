@@ -17,9 +17,14 @@
 #include <algorithm>
 #include <unordered_set>
 
+#include <QDebug>
+#include <QDir>
+#include <QFileInfo>
 #include <QJsonArray>
 #include <QGridLayout>
 #include <QFileDialog>
+#include <QRegularExpression>
+#include <QSet>
 #include <QStringList>
 #include <QWidget>
 
@@ -34,6 +39,53 @@ namespace
         temp.insert(pos, ".");
         return temp;
     }
+
+    bool hasDataInArgument(const QJsonObject& scriptText) {
+        return std::ranges::any_of(scriptText["arguments"].toArray(), [](const QJsonValue& argument) {
+            return argument.toObject()["type"].toString() == "mv-data-in";
+            });
+    }
+
+    BatchMode readBatchMode(const QJsonObject& scriptText) {
+        const QJsonValue batch = scriptText["batch"];
+
+        BatchMode batchMode = BatchMode::None;
+
+        if (batch.isBool())
+            batchMode = batch.toBool() ? BatchMode::PerDataset : BatchMode::None;
+        else if (batch.toString() == "per-dataset")
+            batchMode = BatchMode::PerDataset;
+        else if (batch.toString() == "all")
+            batchMode = BatchMode::AllDatasets;
+
+        // the selected datasets are passed through the first mv-data-in argument
+        if (batchMode != BatchMode::None && !hasDataInArgument(scriptText)) {
+            qWarning() << "Script" << scriptText["name"].toString() << "declares batch but has no mv-data-in argument, it is not offered for several datasets";
+            return BatchMode::None;
+        }
+
+        return batchMode;
+    }
+
+    // e.g. out.png -> out_<dataset name>.png
+    QString batchOutputPath(const QString& filePath, const QString& suffix) {
+        if (filePath.isEmpty())
+            return filePath;
+
+        const QFileInfo fileInfo(filePath);
+        const QString fileName = fileInfo.suffix().isEmpty() ?
+            QString("%1_%2").arg(fileInfo.completeBaseName(), suffix) :
+            QString("%1_%2.%3").arg(fileInfo.completeBaseName(), suffix, fileInfo.suffix());
+
+        return fileInfo.dir().filePath(fileName);
+    }
+}
+
+PythonScriptContent::PythonScriptContent(const QString& scriptPathIn, const QJsonObject& scriptTextIn) :
+    scriptPath(scriptPathIn),
+    scriptText(scriptTextIn),
+    batchMode(readBatchMode(scriptTextIn))
+{
 }
 
 // =============================================================================
@@ -42,12 +94,21 @@ namespace
 
 PythonScript::PythonScript(const QString& title, const Type& type, const QString& interpreterVersion, const QString& scriptPath, const QJsonObject& scriptText, JupyterLauncher* launcher, QObject* parent) :
     Script(title, type, Language::Python, mv::util::Version(insertDotAtPos(interpreterVersion, 1)), scriptPath),
+    _interpreterVersion(interpreterVersion),
     _scriptContent(scriptPath, scriptText),
     _launcherPlugin(launcher)
 {
 
 }
 
+std::shared_ptr<PythonScript> PythonScript::createBatch(const mv::Datasets& datasets) const
+{
+    auto batchScript = std::make_shared<PythonScript>(getTitle(), getType(), _interpreterVersion, _scriptContent.scriptPath, _scriptContent.scriptText, _launcherPlugin);
+    batchScript->setDataTypes(getDataTypes());
+    batchScript->_scriptContent.batchDatasets = datasets;
+    return batchScript;
+}
+
 // =============================================================================
 // ScriptDialog 
 // =============================================================================
@@ -144,6 +205,7 @@ void ScriptDialog::populateDialog()
                 }
 
                 _argumentMap[arg] = outputFileName;
+                _fileOutArguments.insert(arg);
             }
             else if (type == "str") {
                 auto widgetAction = _argumentActions.emplace_back(new mv::gui::StringAction(this, name));
@@ -216,6 +278,22 @@ void ScriptDialog::populateDialog()
                     });
 
             }
+            else if (type == "mv-data-in" && !_scriptContent->batchDatasets.isEmpty() && _batchArgument.isEmpty()) {
+                // the first dataset argument receives the selected datasets
+                _batchArgument = arg;
+
+                QStringList datasetNames;
+                for (const auto& dataset : _scriptContent->batchDatasets) {
+                    datasetNames << dataset->getGuiName();
+                }
+
+                auto widgetAction = _argumentActions.emplace_back(new mv::gui::StringAction(this, name));
+                auto stringAction = static_cast<mv::gui::StringAction*>(widgetAction);
+                stringAction->setDefaultWidgetFlags(mv::gui::StringAction::WidgetFlag::Label);
+                stringAction->setString(QString("%1 datasets: %2").arg(datasetNames.size()).arg(datasetNames.join(", ")));
+                layout->addWidget(widgetAction->createLabelWidget(this), ++row, 0, 1, 1);
+                layout->addWidget(widgetAction->createWidget(this), row, 1, 1, -1);
+            }
             else if (type == "mv-data-in") {
                 auto widgetAction = _argumentActions.emplace_back(new mv::gui::DatasetPickerAction(this, name));
                 auto datasetPickerAction = static_cast<mv::gui::DatasetPickerAction*>(widgetAction);
@@ -262,6 +340,16 @@ void ScriptDialog::runScript() {
         return;
     }
 
+    if (!_batchArgument.isEmpty()) {
+        runBatch();
+        return;
+    }
+
+    if (!_scriptContent->batchDatasets.isEmpty()) {
+        qWarning() << "ScriptDialog::runScript: script" << _scriptContent->scriptPath << "has no mv-data-in argument for the selected datasets, not running it";
+        return;
+    }
+
     QStringList scriptParams;
 
     for (auto& [param, value] : _argumentMap) {
@@ -271,3 +359,56 @@ void ScriptDialog::runScript() {
 
     _launcherPlugin->runScriptInKernel(_scriptContent->scriptPath, scriptParams);
 }
+
+void ScriptDialog::runBatch() {
+    QList<QStringList> paramsPerRun;
+
+    if (_scriptContent->batchMode == BatchMode::AllDatasets) {
+        QStringList scriptParams;
+
+        for (auto& [param, value] : _argumentMap) {
+            if (param == _batchArgument)
+                continue;
+
+            scriptParams.append(param);
+            scriptParams.append(value);
+        }
+
+        scriptParams.append(_batchArgument);
+        for (const auto& dataset : _scriptContent->batchDatasets) {
+            scriptParams.append(dataset.getDatasetId());
+        }
+
+        paramsPerRun.append(scriptParams);
+    }
+    else {
+        // runs write to separate files, named after their dataset
+        QSet<QString> outputSuffixes;
+
+        for (qsizetype run = 0; run < _scriptContent->batchDatasets.size(); ++run) {
+            const auto& dataset = _scriptContent->batchDatasets[run];
+
+            QString outputSuffix = dataset->getGuiName().replace(QRegularExpression(R"([^\w\-]+)"), "_");
+            if (outputSuffix.isEmpty() || outputSuffixes.contains(outputSuffix))
+                outputSuffix += QString("_%1").arg(run + 1);
+            outputSuffixes.insert(outputSuffix);
+
+            QStringList scriptParams;
+
+            for (auto& [param, value] : _argumentMap) {
+                scriptParams.append(param);
+
+                if (param == _batchArgument)
+                    scriptParams.append(dataset.getDatasetId());
+                else if (_fileOutArguments.contains(param))
+                    scriptParams.append(batchOutputPath(value, outputSuffix));
+                else
+                    scriptParams.append(value);
+            }
+
+            paramsPerRun.append(scriptParams);
+        }
+    }
+
+    _launcherPlugin->runScriptBatchInKernel(_scriptContent->scriptPath, paramsPerRun);
+}
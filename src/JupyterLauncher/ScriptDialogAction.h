@@ -1,10 +1,15 @@
 #pragma once
 
+#include <Dataset.h>
+#include <Set.h>
+
 #include <actions/TriggerAction.h>
 #include <actions/WidgetAction.h>
 #include <util/Script.h>
 
+#include <memory>
 #include <unordered_map>
+#include <unordered_set>
 #include <vector>
 
 #include <QDialog>
@@ -14,12 +19,28 @@
 class QWidget;
 class JupyterLauncher;
 
+/**
+ * Scripts that declare "batch" in their json are offered for a selection of several datasets.
+ * With "batch": true (or "per-dataset") the script runs once per dataset, with the dataset id
+ * as its first mv-data-in argument and output files suffixed with the dataset name.
+ * With "batch": "all" it runs once with all dataset ids after that argument (use nargs="+").
+ * Scripts without an mv-data-in argument are not run as a batch.
+ */
+enum class BatchMode
+{
+    None,
+    PerDataset,
+    AllDatasets,
+};
+
 struct PythonScriptContent
 {
     PythonScriptContent() = default;
-    PythonScriptContent(const QString& scriptPathIn, const QJsonObject& scriptTextIn) : scriptPath(scriptPathIn), scriptText(scriptTextIn) {}
+    PythonScriptContent(const QString& scriptPathIn, const QJsonObject& scriptTextIn);
     QString scriptPath = {};
     QJsonObject scriptText = {};
+    BatchMode batchMode = BatchMode::None;
+    mv::Datasets batchDatasets = {};        /** Selected datasets the script runs on as a batch */
 };
 
 class ScriptDialog : public QDialog
@@ -32,12 +53,15 @@ public:
 
 private:
     void runScript();
+    void runBatch();
 
 private:
     mv::gui::TriggerAction                  _okButton;
     QWidget*                                _okButtonWidget = nullptr;
     std::vector<mv::gui::WidgetAction*>     _argumentActions = {};
     std::unordered_map<QString, QString>    _argumentMap = {};
+    QString                                 _batchArgument = {};        /** Receives the ids of the batch datasets */
+    std::unordered_set<QString>             _fileOutArguments = {};
 
     PythonScriptContent*                    _scriptContent = nullptr;
     JupyterLauncher*                        _launcherPlugin = nullptr;
@@ -61,6 +85,11 @@ public:
      */
     explicit PythonScript(const QString& title, const Type& type, const QString& interpreterVersion, const QString& scriptPath, const QJsonObject& scriptText, JupyterLauncher* launcher, QObject* parent = nullptr);
 
+    bool isBatch() const { return _scriptContent.batchMode != BatchMode::None; }
+
+    /** Copy of this script that runs on the given datasets as a batch */
+    std::shared_ptr<PythonScript> createBatch(const mv::Datasets& datasets) const;
+
     /** Runs the script */
     void run() override {
         auto dialog = new ScriptDialog(nullptr, &_scriptContent, _launcherPlugin);
@@ -70,6 +99,7 @@ public:
     }
 
 private:
+    QString             _interpreterVersion = {};
     PythonScriptContent _scriptContent = {};
     JupyterLauncher*    _launcherPlugin = nullptr;
 };
@@ -0,0 +1,102 @@
+#include "AsyncTransfer.h"
+
+#include "InterpreterGil.h"
+
+#include <QCoreApplication>
+#include <QThread>
+#include <QThreadPool>
+
+#include <format>
+#include <mutex>
+#include <stdexcept>
+#include <utility>
+
+namespace py = pybind11;
+
+namespace
+{
+    // Worker pool completing the *_async functions, owned by the JupyterPlugin, see set_async_pool
+    // Datasets are resolved on the GUI thread and copied on the pool, which keeps the calling python thread free
+    std::mutex      asyncPoolMutex;
+    QThreadPool*    asyncPool = nullptr;    /** Guarded by asyncPoolMutex */
+
+    // Returns an asyncio future when called from a running event loop, otherwise the concurrent.futures.Future itself
+    py::object as_awaitable(const py::object& future)
+    {
+        const py::module_ asyncio = py::module_::import("asyncio");
+
+        if (asyncio.attr("_get_running_loop")().is_none())
+            return future;
+
+        return asyncio.attr("wrap_future")(future);
+    }
+
+    // Returns whether the calling thread is the GUI thread
+    bool on_gui_thread()
+    {
+        auto* app = QCoreApplication::instance();
+        return app && QThread::currentThread() == app->thread();
+    }
+}
+
+namespace mvstudio_core {
+    void set_async_pool(QThreadPool* pool)
+    {
+        std::scoped_lock lock(asyncPoolMutex);
+        asyncPool = pool;
+    }
+}
+
+// Completing the future needs the GUI thread, so waiting for it there would never return
+py::object create_async_future_type()
+{
+    const py::object futureBase = py::module_::import("concurrent.futures").attr("Future");
+    py::object futureType       = py::module_::import("builtins").attr("type")("AsyncFuture", py::make_tuple(futureBase), py::dict());
+
+    for (const char* name : { "result", "exception" }) {
+        const py::object baseMethod = futureBase.attr(name);
+
+        py::setattr(futureType, name, py::cpp_function([baseMethod, name](const py::object& self, const py::object& timeout) -> py::object {
+            if (on_gui_thread() && !self.attr("done")().cast<bool>())
+                throw std::runtime_error(std::format("{}() of a pending mvstudio_core future cannot be called on the GUI thread, "
+                    "await it or call {}() from another thread", name, name));
+
+            return baseMethod(self, timeout);
+        }, py::name(name), py::is_method(futureType), py::arg("timeout") = py::none()));
+    }
+
+    return futureType;
+}
+
+// The python objects captured by work are released holding the GIL as well
+py::object submit_async(std::function<py::object()> work)
+{
+    py::object future = py::module_::import("mvstudio_core").attr("AsyncFuture")();
+
+    // the pool is not removed while a task is started
+    std::scoped_lock lock(asyncPoolMutex);
+    if (!asyncPool)
+        throw std::runtime_error("mvstudio_core: asynchronous transfers are not available, the plugin is shutting down");
+
+    asyncPool->start([interpreter = current_interpreter(), future, work = std::move(work)]() mutable {
+        interpreter_gil_acquire acquire(*interpreter);
+
+        auto task   = std::move(work);
+        auto result = std::move(future);
+
+        if (!result.attr("set_running_or_notify_cancel")().cast<bool>())
+            return;
+
+        try {
+            result.attr("set_result")(task());
+        }
+        catch (py::error_already_set& e) {
+            result.attr("set_exception")(e.value());
+        }
+        catch (const std::exception& e) {
+            result.attr("set_exception")(py::module_::import("builtins").attr("RuntimeError")(e.what()));
+        }
+    });
+
+    return as_awaitable(future);
+}
@@ -0,0 +1,27 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <functional>
+
+class QThreadPool;
+
+/**
+ * Asynchronous transfers
+ *
+ * The *_async functions of mvstudio_core return a future right away and complete it on a worker pool,
+ * which keeps the calling python thread free. The pool is owned by the JupyterPlugin.
+ */
+
+namespace mvstudio_core {
+    // Pool that completes the *_async functions, these raise while it is not set
+    void set_async_pool(QThreadPool* pool);
+}
+
+/** concurrent.futures.Future whose result() and exception() raise on the GUI thread while it is pending, registered as mvstudio_core.AsyncFuture */
+pybind11::object create_async_future_type();
+
+/** Runs work on the pool, holding the GIL of the calling interpreter, and returns its future as awaitable, see as_awaitable */
+pybind11::object submit_async(std::function<pybind11::object()> work);
@@ -38,3 +38,13 @@ py::buffer_info createBuffer(const py::array& data)
     return buf_info;
 }
 
+mv::DataHierarchyItem* findHierarchyItem(const QString& guid)
+{
+    if (mv::DataHierarchyItem* item = mv::dataHierarchy().getItem(guid))
+        return item;
+
+    if (const auto dataset = mv::data().getDataset(guid); dataset.isValid())
+        return &dataset->getDataHierarchyItem();
+
+    return nullptr;
+}
@@ -1,50 +1,169 @@
 #pragma once
 
 #include <CoreInterface.h>
+#include <DataHierarchyItem.h>
 #include <Dataset.h>
 #include <PointData/PointData.h>
 
+#include "DimensionStats.h"
+#include "InterpreterGil.h"
+
 #undef slots
 #include <pybind11/buffer_info.h>
 #include <pybind11/numpy.h>
 #include <pybind11/pybind11.h>
 #include <pybind11/pytypes.h>
 #include <pybind11/stl.h>       // a.o. for vector conversions
+#include <pybind11/subinterpreter.h>
 #define slots Q_SLOTS
 
-#include <QString>
+#include <QCoreApplication>
 #include <QDebug>
+#include <QMetaObject>
+#include <QString>
+#include <QThread>
 
 #include <algorithm>
 #include <array>
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <exception>
+#include <functional>
+#include <limits>
+#include <memory>
 #include <numeric>
+#include <optional>
+#include <span>
 #include <string>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
+#include <variant>
 #include <vector>
 
 std::vector<QString> toQStringVec(const std::vector<std::string>& vec_str);
 
 pybind11::buffer_info createBuffer(const pybind11::array& data);
 
+// Returns the data hierarchy item with the given item guid or dataset guid, or nullptr
+// Must be called on the GUI thread
+mv::DataHierarchyItem* findHierarchyItem(const QString& guid);
+
+// Runs f on the GUI thread, where ManiVault objects may be accessed, and returns its result
+// Called from another thread (the kernel interpreter), the GIL is released while waiting 
+// and f holds the GIL of the calling interpreter on the GUI thread. Exceptions thrown by f are rethrown here.
+template<typename F>
+std::invoke_result_t<F> run_on_main_thread(F&& f)
+{
+    using R = std::invoke_result_t<F>;
+
+    QCoreApplication* app = QCoreApplication::instance();
+    if (!app || QThread::currentThread() == app->thread())
+        return f();
+
+    using Result = std::conditional_t<std::is_void_v<R>, bool, std::optional<R>>;
+    Result result = {};
+    std::exception_ptr error = nullptr;
+    const auto interpreter = current_interpreter();
+
+    {
+        pybind11::gil_scoped_release release;
+        QMetaObject::invokeMethod(app, [&]() {
+            interpreter_gil_acquire acquire(*interpreter);
+            try {
+                if constexpr (std::is_void_v<R>)
+                    f();
+                else
+                    result.emplace(f());
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        }, Qt::BlockingQueuedConnection);
+    }
+
+    if (error)
+        std::rethrow_exception(error);
+
+    if constexpr (!std::is_void_v<R>)
+        return std::move(*result);
+}
+
+// Wraps a binding function such that it runs on the GUI thread, see run_on_main_thread
+template<typename R, typename... Args>
+auto on_main_thread(R(*f)(Args...))
+{
+    return [f](Args... args) -> R {
+        return run_on_main_thread([&]() -> R { return f(std::forward<Args>(args)...); });
+    };
+}
+
+template<typename R, typename C>
+auto on_main_thread(R(C::*f)() const)
+{
+    return [f](const C& self) -> R {
+        return run_on_main_thread([&]() -> R { return (self.*f)(); });
+    };
+}
+
 template<class T>
-pybind11::array populate_pyarray(mv::Dataset<Points>& inputPoints, unsigned int numPoints, unsigned int numDimensions)
+pybind11::array populate_pyarray(Points& inputPoints, unsigned int numPoints, unsigned int numDimensions)
 {
     std::vector<unsigned int> dim_indices(numDimensions);
     std::iota(dim_indices.begin(), dim_indices.end(), 0);
 
-    std::vector<T> data;
-    size_t size = static_cast<size_t>(numPoints) * numDimensions;
-    data.resize(size);
-
-    inputPoints->populateDataForDimensions<std::vector<T>, std::vector<unsigned int>>(data, dim_indices);
+    const size_t size = static_cast<size_t>(numPoints) * numDimensions;
 
     auto result = pybind11::array_t<T>({ numPoints, numDimensions });
-    pybind11::buffer_info result_info = result.request();
-    T* output = static_cast<T*>(result_info.ptr);
-    for (size_t i = 0; i < size; i++) {
-        output[i] = data[i];
+    std::span<T> output(result.mutable_data(), size);
+
+    // pure C++ copy straight into the numpy buffer, other python threads may run meanwhile
+    {
+        pybind11::gil_scoped_release release;
+        inputPoints.populateDataForDimensions<std::span<T>, std::vector<unsigned int>>(output, dim_indices);
     }
+
+    return result;
+}
+
+// numpy has no bfloat16, such data is handed to python as float
+template<typename T>
+using numpy_element_t = std::conditional_t<std::is_same_v<T, biovault::bfloat16_t>, float, T>;
+
+// Copies numRows rows starting at startRow of the row-major (num_points x numDimensions) data to output
+// rowIndices selects the rows of a subset - rows are taken as is if it is empty
+template<typename OutT, typename T>
+void copy_rows(const T* data, size_t numDimensions, const std::vector<std::uint32_t>& rowIndices, size_t startRow, size_t numRows, OutT* output)
+{
+    if constexpr (std::is_same_v<OutT, T>) {
+        if (rowIndices.empty()) {
+            std::memcpy(output, data + startRow * numDimensions, numRows * numDimensions * sizeof(T));
+            return;
+        }
+    }
+
+    for (size_t i = 0; i < numRows; ++i) {
+        const size_t row = rowIndices.empty() ? startRow + i : rowIndices[startRow + i];
+        const T* rowData = data + row * numDimensions;
+        OutT* rowOutput  = output + i * numDimensions;
+
+        for (size_t dim = 0; dim < numDimensions; ++dim)
+            rowOutput[dim] = static_cast<OutT>(rowData[dim]);
+    }
+}
+
+// As copy_rows, into a new numpy array of shape (numRows, numDimensions)
+template<typename OutT, typename T>
+pybind11::array copy_rows_to_pyarray(const T* data, size_t numDimensions, const std::vector<std::uint32_t>& rowIndices, size_t startRow, size_t numRows)
+{
+    auto result = pybind11::array_t<OutT>({ numRows, numDimensions });
+    OutT* output = static_cast<OutT*>(result.request().ptr);
+
+    pybind11::gil_scoped_release release;
+
+    copy_rows(data, numDimensions, rowIndices, startRow, numRows, output);
+
     return result;
 }
 
@@ -128,6 +247,8 @@ void conv_img_points_from_numpy_array(const void* data_in, const std::array<size
         "This numpy dtype was converted to float to match the ManiVault data model.",
         builtins.attr("UserWarning"));
 
+    pybind11::gil_scoped_release release;
+
     auto data_in_U = static_cast<const U*>(data_in);
     std::vector<T> data_out = {};
     data_out.resize(band_size * num_bands);
@@ -151,6 +272,8 @@ void set_img_points_from_numpy_array(const void* data_in, const std::array<size_
     const size_t band_size = shape[0] * shape[1];
     const size_t num_bands = shape[2];
 
+    pybind11::gil_scoped_release release;
+
     std::vector<T> data_out = {};
     data_out.resize(band_size * num_bands);
 
@@ -162,15 +285,27 @@ void set_img_points_from_numpy_array(const void* data_in, const std::array<size_
     points->setData(std::move(data_out), num_bands);
 }
 
-// when types are different, setting points
+// Point values of a numpy array in a type PointData supports, see point_values_from_numpy
+// Creating them does not access ManiVault, only moving them into a dataset does
+struct PointValues
+{
+    std::variant<std::vector<float>, std::vector<std::int8_t>, std::vector<std::uint8_t>, std::vector<std::int16_t>, std::vector<std::uint16_t>> values;
+    size_t numDimensions = 0;
+};
+
+// Copies the numpy data (num_points x num_dims) and casts it from U to T
 template<typename T, typename U>
-void set_points_from_numpy_array_diff_type(const void* data_in, const std::array<size_t, 2>& shape, mv::Dataset<Points>& points, bool flip)
+PointValues convert_point_values(const void* data_in, const std::array<size_t, 2>& shape)
 {
-    auto warnings = pybind11::module::import("warnings");
-    auto builtins = pybind11::module::import("builtins");
-    warnings.attr("warn")(
-        "This numpy dtype was converted to float to match the ManiVault data model.",
-        builtins.attr("UserWarning"));
+    if constexpr (!std::is_same_v<T, U>) {
+        auto warnings = pybind11::module::import("warnings");
+        auto builtins = pybind11::module::import("builtins");
+        warnings.attr("warn")(
+            "This numpy dtype was converted to float to match the ManiVault data model.",
+            builtins.attr("UserWarning"));
+    }
+
+    pybind11::gil_scoped_release release;
 
     const size_t num_values = shape[0] * shape[1];  // num_points * num_dims
     const U* data_in_U = static_cast<const U*>(data_in);
@@ -178,31 +313,13 @@ void set_points_from_numpy_array_diff_type(const void* data_in, const std::array
     std::vector<T> data_out = {};
     data_out.resize(num_values);
 
-    for (size_t i = 0; i < num_values; ++i)
-        data_out[i] = static_cast<const T>(data_in_U[i]);
-
-    points->setData(std::move(data_out), shape[1]);
-}
-
-// when types are the same, setting points
-template<typename T>
-void set_points_from_numpy_array_same_type(const void* data_in, const std::array<size_t, 2>& shape, mv::Dataset<Points>& points, bool flip)
-{
-    const size_t num_values = shape[0] * shape[1];  // num_points * num_dims
-    std::vector<T> data_out = {};
-    data_out.resize(num_values);
-    std::memcpy(data_out.data(), static_cast<const T*>(data_in), num_values * sizeof(T));
-
-    points->setData(std::move(data_out), shape[1]);
-}
-
-template<typename T, typename U>
-void set_points_from_numpy_array(const void* data_in, const std::array<size_t, 2>& shape, mv::Dataset<Points>& points, bool flip = false)
-{
     if constexpr (std::is_same_v<T, U>)
-        set_points_from_numpy_array_same_type<T>(data_in, shape, points, flip);
+        std::memcpy(data_out.data(), data_in_U, num_values * sizeof(T));
     else
-        set_points_from_numpy_array_diff_type<T, U>(data_in, shape, points, flip);
+        for (size_t i = 0; i < num_values; ++i)
+            data_out[i] = static_cast<const T>(data_in_U[i]);
+
+    return { std::move(data_out), shape[1] };
 }
 
 template <typename T>
@@ -218,86 +335,107 @@ std::vector<T> py_array_to_vector(const pybind11::array_t<T>& array) {
     return std::vector<T>(data_ptr, data_ptr + buf.shape[0]);
 }
 
-/* Creates new or derived data
-*  The Lambda GeneratePointsFunc controls the manner of creating the new point data
-*  This function mainly converts the python data
+/* Converts the python data for add_point_values
+*  Returns nullopt if the data cannot be converted, this does not access ManiVault
 */
-template <typename GeneratePointsFunc>
-std::string add_point_data(const pybind11::array& data, const std::vector<std::string>& dimensionNames, GeneratePointsFunc generatePointsData)
+inline std::optional<PointValues> point_values_from_numpy(const pybind11::array& data)
 {
-    std::string guid = "";
     const pybind11::dtype dtype = data.dtype();
     const pybind11::buffer_info buf_info = createBuffer(data);
     const void* py_data_storage_ptr = buf_info.ptr;
 
     if (!(data.flags() & pybind11::array::c_style)) {
         qDebug() << "add_point_data: Numpy array must by c-contiguous, use np.ascontiguousarray(data)";
-        return guid;
+        return std::nullopt;
     }
 
     if (!py_data_storage_ptr) {
         qDebug() << "add_point_data: python data transfer failed";
-        return guid;
+        return std::nullopt;
     }
 
     if (buf_info.shape.size() != 2) {
         qDebug() << "add_point_data: require numpy data of shape (num_points, num_dims). Instead got: " << buf_info.shape;
-        return guid;
+        return std::nullopt;
     }
 
     const std::array<size_t, 2> shape = { static_cast<size_t>(buf_info.shape.front()), static_cast<size_t>(buf_info.shape.back()) };
 
-    void (*point_setter)(const void* data_in, const std::array<size_t, 2>&shape, mv::Dataset<Points>&points, bool flip) = nullptr;
+    PointValues (*point_converter)(const void* data_in, const std::array<size_t, 2>& shape) = nullptr;
 
     // PointData is limited in its type support - hopefully the commented types wil be added soon
     if (dtype.is(pybind11::dtype::of<std::uint8_t>()))
-        point_setter = set_points_from_numpy_array<std::uint8_t, std::uint8_t>;
+        point_converter = convert_point_values<std::uint8_t, std::uint8_t>;
     else if (dtype.is(pybind11::dtype::of<std::int8_t>()))
-        point_setter = set_points_from_numpy_array<std::int8_t, std::int8_t>;
+        point_converter = convert_point_values<std::int8_t, std::int8_t>;
     else if (dtype.is(pybind11::dtype::of<std::uint16_t>()))
-        point_setter = set_points_from_numpy_array<std::uint16_t, std::uint16_t>;
+        point_converter = convert_point_values<std::uint16_t, std::uint16_t>;
     else if (dtype.is(pybind11::dtype::of<std::int16_t>()))
-        point_setter = set_points_from_numpy_array<std::int16_t, std::int16_t>;
+        point_converter = convert_point_values<std::int16_t, std::int16_t>;
     // 32 int are cast to float
     else if (dtype.is(pybind11::dtype::of<std::uint32_t>()))
-        point_setter = set_points_from_numpy_array<float, std::uint32_t>;
+        point_converter = convert_point_values<float, std::uint32_t>;
     else if (dtype.is(pybind11::dtype::of<std::int32_t>()))
-        point_setter = set_points_from_numpy_array<float, std::int32_t>;
+        point_converter = convert_point_values<float, std::int32_t>;
     //Unsupported <std::uint64_t> :
     //Unsupported <std::int64_t> :
     else if (dtype.is(pybind11::dtype::of<float>()))
-        point_setter = set_points_from_numpy_array<float, float>;
+        point_converter = convert_point_values<float, float>;
     else if (dtype.is(pybind11::dtype::of<double>()))
-        point_setter = set_points_from_numpy_array<float, double>;
+        point_converter = convert_point_values<float, double>;
     else
     {
         qDebug() << "add_point_data: type not supported (e.g. uint64_t or int64_t): " << QString(dtype.kind());
-        return guid;
-    }
-
-    if (point_setter != nullptr)
-    {
-        mv::Dataset<Points> points = generatePointsData();
-
-        point_setter(py_data_storage_ptr, shape, points, false);
-
-        if (dimensionNames.size() == shape[1])
-            points->setDimensionNames(toQStringVec(dimensionNames));
-
-        mv::events().notifyDatasetDataChanged(points);
-
-        guid = points.getDatasetId().toStdString();
 
-        qDebug() << "add_point_data: " << QString(guid.c_str());
-    }
-    else
-    {
         auto warnings = pybind11::module::import("warnings");
         auto builtins = pybind11::module::import("builtins");
         warnings.attr("warn")(
             "This numpy dtype could not be converted to a ManiVaultStudio supported type.",
             builtins.attr("UserWarning"));
+
+        return std::nullopt;
     }
 
+    return point_converter(py_data_storage_ptr, shape);
+}
+
+/* Creates new or derived data and moves the converted values into it, on the GUI thread
+*  The Lambda GeneratePointsFunc controls the manner of creating the new point data
+*/
+template <typename GeneratePointsFunc>
+std::string add_point_values(PointValues&& pointValues, const std::vector<std::string>& dimensionNames, GeneratePointsFunc generatePointsData)
+{
+    mv::Dataset<Points> points = generatePointsData();
+
+    if (!points.isValid())
+        return "";
+
+    const size_t numDimensions = pointValues.numDimensions;
+    std::visit([&points, numDimensions](auto& values) { points->setData(std::move(values), numDimensions); }, pointValues.values);
+
+    if (dimensionNames.size() == numDimensions)
+        points->setDimensionNames(toQStringVec(dimensionNames));
+
+    mv::events().notifyDatasetDataChanged(points);
+
+    const std::string guid = points.getDatasetId().toStdString();
+
+    qDebug() << "add_point_data: " << QString(guid.c_str());
+
     return guid;
 }
+
+/* Creates new or derived data
+*  The Lambda GeneratePointsFunc controls the manner of creating the new point data
+*  This function mainly converts the python data
+*/
+template <typename GeneratePointsFunc>
+std::string add_point_data(const pybind11::array& data, const std::vector<std::string>& dimensionNames, GeneratePointsFunc generatePointsData)
+{
+    auto pointValues = point_values_from_numpy(data);
+
+    if (!pointValues)
+        return "";
+
+    return add_point_values(std::move(*pointValues), dimensionNames, generatePointsData);
+}
@@ -0,0 +1,379 @@
+#include "DataStreamComm.h"
+
+#include "BindingUtils.h"
+
+#include <DataHierarchyItem.h>
+#include <ImageData/ImageData.h>
+#include <ImageData/Images.h>
+#include <PointData/PointData.h>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMetaObject>
+#include <QPair>
+#include <QString>
+#include <QThread>
+#include <QVector>
+
+#include <algorithm>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+
+namespace
+{
+    constexpr std::uint64_t defaultChunkRows   = 65'536;
+    constexpr std::uint64_t defaultTileRows    = 256;
+    constexpr std::uint64_t defaultWindow      = 4;
+
+    // Comm messages are handled on the kernel interpreter thread, ManiVault is accessed on the GUI thread
+    // Unlike run_on_main_thread this does not involve the GIL
+    template<typename F>
+    std::invoke_result_t<F> invoke_on_gui_thread(F&& f)
+    {
+        QCoreApplication* app = QCoreApplication::instance();
+        if (!app || QThread::currentThread() == app->thread())
+            return f();
+
+        std::invoke_result_t<F> result = {};
+        std::exception_ptr error = nullptr;
+
+        QMetaObject::invokeMethod(app, [&]() {
+            try {
+                result = f();
+            }
+            catch (...) {
+                error = std::current_exception();
+            }
+        }, Qt::BlockingQueuedConnection);
+
+        if (error)
+            std::rethrow_exception(error);
+
+        return result;
+    }
+
+    template<typename T>
+    constexpr const char* dtype_name()
+    {
+        if constexpr (std::is_same_v<T, float>)              return "float32";
+        else if constexpr (std::is_same_v<T, std::int32_t>)  return "int32";
+        else if constexpr (std::is_same_v<T, std::uint32_t>) return "uint32";
+        else if constexpr (std::is_same_v<T, std::int16_t>)  return "int16";
+        else if constexpr (std::is_same_v<T, std::uint16_t>) return "uint16";
+        else if constexpr (std::is_same_v<T, std::int8_t>)   return "int8";
+        else if constexpr (std::is_same_v<T, std::uint8_t>)  return "uint8";
+        else                                                 return "unknown";
+    }
+
+    // Returns the point dataset of an item, or of its parent if the item holds derived non-point data
+    mv::Dataset<Points> points_for(const QString& guid)
+    {
+        mv::DataHierarchyItem* item = findHierarchyItem(guid);
+
+        if (item && item->getDataType() != PointType)
+            item = item->getParent();
+
+        if (!item || item->getDataType() != PointType)
+            throw std::runtime_error("dataset is not point data");
+
+        return item->getDataset<Points>();
+    }
+
+    std::uint64_t request_value(const nl::json& request, const char* key, std::uint64_t defaultValue)
+    {
+        const std::uint64_t value = request.value(key, defaultValue);
+        return value > 0 ? value : defaultValue;
+    }
+}
+
+DataStreamComm::DataStreamComm(xeus::xcomm&& comm, DataStreamComms& comms) :
+    _comm(std::move(comm)),
+    _comms(comms)
+{
+    _comm.on_message([this](const xeus::xmessage& message) { handleMessage(message); });
+    _comm.on_close([this](const xeus::xmessage&) {
+        _stream.reset();
+        _comms.remove(_comm.id());
+    });
+}
+
+void DataStreamComms::registerTarget(xeus::xcomm_manager& manager)
+{
+    manager.register_comm_target("mvstudio_data", [this](xeus::xcomm&& comm, const xeus::xmessage&) {
+        _closedComms.clear();
+
+        const xeus::xguid id = comm.id();
+        _openComms[id] = std::make_unique<DataStreamComm>(std::move(comm), *this);
+    });
+}
+
+void DataStreamComms::remove(const xeus::xguid& id)
+{
+    // the comm is still running its close handler, it cannot be destroyed yet
+    if (auto node = _openComms.extract(id))
+        _closedComms.push_back(std::move(node.mapped()));
+}
+
+void DataStreamComms::clear()
+{
+    _openComms.clear();
+    _closedComms.clear();
+}
+
+void DataStreamComm::handleMessage(const xeus::xmessage& message)
+{
+    const nl::json data         = message.content().value("data", nl::json::object());
+    const std::string request   = data.value("request", std::string());
+
+    try {
+        if (request == "points")
+            startPoints(data);
+        else if (request == "image")
+            startImage(data);
+        else if (request == "selection")
+            sendSelection(data);
+        else if (request == "ack") {
+            if (_stream && data.value("stream", std::uint64_t{ 0 }) == _stream->id && _stream->inFlight > 0) {
+                _stream->inFlight--;
+                sendChunks();
+            }
+        }
+        else if (request == "cancel") {
+            if (_stream && data.value("stream", std::uint64_t{ 0 }) == _stream->id)
+                _stream.reset();
+        }
+        else
+            sendError("unknown request: " + request);
+    }
+    catch (const std::exception& e) {
+        sendError(e.what());
+    }
+}
+
+void DataStreamComm::startPoints(const nl::json& request)
+{
+    const QString datasetId         = QString::fromStdString(request.value("dataset", std::string()));
+    const std::uint64_t chunkRows   = request_value(request, "chunk_rows", defaultChunkRows);
+
+    struct Layout {
+        std::uint64_t   numRows = 0;
+        std::uint64_t   numDimensions = 0;
+        std::string     dtype = {};
+    };
+
+    const Layout layout = invoke_on_gui_thread([&datasetId]() {
+        auto points = points_for(datasetId);
+
+        Layout result;
+        result.numRows          = points->isFull() ? points->getNumPoints() : points->indices.size();
+        result.numDimensions    = points->getNumDimensions();
+        points->visitFromBeginToEnd([&result](auto begin, auto end) {
+            result.dtype = dtype_name<numpy_element_t<std::remove_cvref_t<decltype(*begin)>>>();
+        });
+
+        return result;
+    });
+
+    Stream stream;
+    stream.id           = ++_lastStreamId;
+    stream.window       = request_value(request, "window", defaultWindow);
+    stream.numChunks    = (layout.numRows + chunkRows - 1) / chunkRows;
+    stream.produce      = [datasetId, chunkRows, layout](std::uint64_t chunk, nl::json& description) {
+        const std::uint64_t startRow    = chunk * chunkRows;
+        const std::uint64_t numRows     = std::min(chunkRows, layout.numRows - startRow);
+
+        description["offset"]   = startRow;
+        description["rows"]     = numRows;
+
+        return invoke_on_gui_thread([&]() {
+            auto points = points_for(datasetId);
+
+            const size_t numDimensions = points->getNumDimensions();
+            const std::uint64_t totalRows = points->isFull() ? points->getNumPoints() : points->indices.size();
+            if (numDimensions != layout.numDimensions || startRow + numRows > totalRows)
+                throw std::runtime_error("dataset changed while streaming");
+
+            const std::vector<std::uint32_t> allRows = {};
+            const std::vector<std::uint32_t>& rowIndices = points->isFull() ? allRows : points->indices;
+
+            xeus::binary_buffer buffer;
+            points->visitFromBeginToEnd([&](auto begin, auto end) {
+                using OutT = numpy_element_t<std::remove_cvref_t<decltype(*begin)>>;
+                buffer.resize(numRows * numDimensions * sizeof(OutT));
+                copy_rows(&*begin, numDimensions, rowIndices, startRow, numRows, reinterpret_cast<OutT*>(buffer.data()));
+            });
+
+            return buffer;
+        });
+    };
+
+    _stream = std::move(stream);
+
+    send({
+        { "event", "begin" },
+        { "stream", _stream->id },
+        { "kind", "points" },
+        { "dtype", layout.dtype },
+        { "shape", { layout.numRows, layout.numDimensions } },
+        { "num_chunks", _stream->numChunks },
+    });
+
+    sendChunks();
+}
+
+void DataStreamComm::startImage(const nl::json& request)
+{
+    const QString datasetId         = QString::fromStdString(request.value("dataset", std::string()));
+    const std::uint64_t tileRows    = request_value(request, "tile_rows", defaultTileRows);
+
+    struct Layout {
+        std::uint64_t numImages = 0;
+        std::uint64_t height = 0;
+        std::uint64_t width = 0;
+        std::uint64_t numComponents = 0;
+    };
+
+    const Layout layout = invoke_on_gui_thread([&datasetId]() {
+        mv::DataHierarchyItem* item = findHierarchyItem(datasetId);
+
+        if (!item || item->getDataType() != ImageType)
+            throw std::runtime_error("dataset is not an image");
+
+        auto images = item->getDataset<Images>();
+
+        Layout result;
+        result.numImages        = images->getNumberOfImages();
+        result.height           = images->getImageSize().height();
+        result.width            = images->getImageSize().width();
+        result.numComponents    = images->getNumberOfComponentsPerPixel();
+
+        return result;
+    });
+
+    const std::uint64_t tilesPerImage = (layout.height + tileRows - 1) / tileRows;
+
+    // The scalar data of the image that is currently being tiled, it is fetched once per image
+    struct ImageCache {
+        std::int64_t    imageIndex = -1;
+        QVector<float>  scalarData = {};
+    };
+    auto cache = std::make_shared<ImageCache>();
+
+    Stream stream;
+    stream.id           = ++_lastStreamId;
+    stream.window       = request_value(request, "window", defaultWindow);
+    stream.numChunks    = layout.numImages * tilesPerImage;
+    stream.produce      = [datasetId, tileRows, tilesPerImage, layout, cache](std::uint64_t chunk, nl::json& description) {
+        const std::uint64_t imageIndex  = chunk / tilesPerImage;
+        const std::uint64_t startRow    = (chunk % tilesPerImage) * tileRows;
+        const std::uint64_t numRows     = std::min(tileRows, layout.height - startRow);
+        const std::uint64_t rowSize     = layout.width * layout.numComponents;
+
+        description["image"]    = imageIndex;
+        description["offset"]   = startRow;
+        description["rows"]     = numRows;
+
+        if (cache->imageIndex != static_cast<std::int64_t>(imageIndex)) {
+            invoke_on_gui_thread([&]() {
+                mv::DataHierarchyItem* item = findHierarchyItem(datasetId);
+
+                if (!item || item->getDataType() != ImageType)
+                    throw std::runtime_error("image dataset was removed while streaming");
+
+                QPair<float, float> scalarDataRange;
+                cache->scalarData.resize(static_cast<qsizetype>(layout.height * rowSize));
+                item->getDataset<Images>()->getImageScalarData(static_cast<std::uint32_t>(imageIndex), cache->scalarData, scalarDataRange);
+                return true;
+            });
+            cache->imageIndex = static_cast<std::int64_t>(imageIndex);
+        }
+
+        xeus::binary_buffer buffer(numRows * rowSize * sizeof(float));
+        std::memcpy(buffer.data(), cache->scalarData.constData() + startRow * rowSize, buffer.size());
+
+        return buffer;
+    };
+
+    _stream = std::move(stream);
+
+    send({
+        { "event", "begin" },
+        { "stream", _stream->id },
+        { "kind", "image" },
+        { "dtype", "float32" },
+        { "shape", { layout.numImages, layout.height, layout.width, layout.numComponents } },
+        { "num_chunks", _stream->numChunks },
+    });
+
+    sendChunks();
+}
+
+void DataStreamComm::sendSelection(const nl::json& request)
+{
+    const QString datasetId = QString::fromStdString(request.value("dataset", std::string()));
+
+    xeus::binary_buffer buffer = invoke_on_gui_thread([&datasetId]() {
+        mv::DataHierarchyItem* item = findHierarchyItem(datasetId);
+
+        if (!item)
+            throw std::runtime_error("no dataset with this id");
+
+        const std::vector<std::uint32_t>& selectionIndices = item->getDataset()->getSelectionIndices();
+
+        xeus::binary_buffer result(selectionIndices.size() * sizeof(std::uint32_t));
+        std::memcpy(result.data(), selectionIndices.data(), result.size());
+        return result;
+    });
+
+    const std::uint64_t numIndices = buffer.size() / sizeof(std::uint32_t);
+    const std::uint64_t id         = ++_lastStreamId;
+
+    // A selection is small, it is sent as a single chunk without waiting for acknowledgements
+    send({ { "event", "begin" }, { "stream", id }, { "kind", "selection" }, { "dtype", "uint32" }, { "shape", { numIndices } }, { "num_chunks", 1 } });
+
+    xeus::buffer_sequence buffers;
+    buffers.push_back(std::move(buffer));
+    send({ { "event", "chunk" }, { "stream", id }, { "index", 0 }, { "offset", 0 }, { "rows", numIndices } }, std::move(buffers));
+    send({ { "event", "end" }, { "stream", id } });
+}
+
+void DataStreamComm::sendChunks()
+{
+    while (_stream && _stream->inFlight < _stream->window && _stream->nextChunk < _stream->numChunks) {
+        const std::uint64_t chunk = _stream->nextChunk++;
+
+        nl::json description = { { "event", "chunk" }, { "stream", _stream->id }, { "index", chunk } };
+
+        xeus::buffer_sequence buffers;
+        buffers.push_back(_stream->produce(chunk, description));
+
+        send(std::move(description), std::move(buffers));
+        _stream->inFlight++;
+    }
+
+    if (_stream && _stream->nextChunk == _stream->numChunks) {
+        send({ { "event", "end" }, { "stream", _stream->id } });
+        _stream.reset();
+    }
+}
+
+void DataStreamComm::sendError(const std::string& message)
+{
+    qWarning() << "DataStreamComm:" << message.c_str();
+
+    nl::json data = { { "event", "error" }, { "message", message } };
+    if (_stream)
+        data["stream"] = _stream->id;
+
+    _stream.reset();
+    send(std::move(data));
+}
+
+void DataStreamComm::send(nl::json data, xeus::buffer_sequence buffers) const
+{
+    _comm.send(nl::json::object(), std::move(data), std::move(buffers));
+}
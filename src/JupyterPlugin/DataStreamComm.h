@@ -0,0 +1,106 @@
+#pragma once
+
+#include <xeus/xcomm.hpp>
+
+#include <cstdint>
+#include <functional>
+#include <map>
+#include <memory>
+#include <optional>
+#include <string>
+#include <vector>
+
+/**
+ * Data stream comm
+ *
+ * Streams ManiVault data to notebook widgets as Jupyter binary buffers.
+ * Widgets open a comm on the "mvstudio_data" target and send requests as comm messages:
+ *
+ *   {"request": "points", "dataset": guid, "chunk_rows": 65536, "window": 4}
+ *   {"request": "image", "dataset": guid, "tile_rows": 256, "window": 4}
+ *   {"request": "selection", "dataset": guid}
+ *   {"request": "ack", "stream": id}
+ *   {"request": "cancel", "stream": id}
+ *
+ * The kernel answers with:
+ *
+ *   {"event": "begin", "stream": id, "kind": ..., "dtype": ..., "shape": [...], "num_chunks": n}
+ *   {"event": "chunk", "stream": id, "index": i, ...}  with the data as one binary buffer
+ *   {"event": "end", "stream": id}
+ *   {"event": "error", "stream": id, "message": ...}
+ *
+ * Point chunks are row blocks of the (num_points x num_dims) data, image chunks are blocks
+ * of image rows (BIP, float32) and a selection is a single uint32 index chunk.
+ * At most "window" chunks are unacknowledged, each "ack" releases the next chunk.
+ * A comm streams one request at a time, a new request replaces the running one.
+ *
+ * The data is copied from ManiVault on the GUI thread straight into the message buffers,
+ * it does not pass through python objects.
+ *
+ * The open comms of a kernel are kept by its DataStreamComms, owned by the kernel interpreter.
+ */
+class DataStreamComms;
+
+class DataStreamComm
+{
+public:
+    DataStreamComm() = delete;
+    DataStreamComm(const DataStreamComm&) = delete;
+    DataStreamComm(xeus::xcomm&& comm, DataStreamComms& comms);
+
+private:
+    void handleMessage(const xeus::xmessage& message);
+
+    void startPoints(const nl::json& request);
+    void startImage(const nl::json& request);
+    void sendSelection(const nl::json& request);
+
+    void sendChunks();
+    void sendError(const std::string& message);
+    void send(nl::json data, xeus::buffer_sequence buffers = {}) const;
+
+private:
+    // Produces the buffer of a chunk and adds its description to the chunk message
+    using ChunkProducer = std::function<xeus::binary_buffer(std::uint64_t chunk, nl::json& description)>;
+
+    struct Stream
+    {
+        std::uint64_t   id          = 0;
+        std::uint64_t   numChunks   = 0;
+        std::uint64_t   nextChunk   = 0;
+        std::uint64_t   inFlight    = 0;    /** Chunks sent but not acknowledged */
+        std::uint64_t   window      = 4;
+        ChunkProducer   produce     = {};
+    };
+
+    xeus::xcomm             _comm;
+    std::optional<Stream>   _stream = {};
+    std::uint64_t           _lastStreamId = 0;
+    DataStreamComms&        _comms;
+};
+
+/**
+ * The open data stream comms of one kernel
+ *
+ * Comms are opened and closed on the interpreter thread of the kernel.
+ * The kernel clears the registry before its comm manager is destroyed, see XeusKernel::~XeusKernel.
+ */
+class DataStreamComms
+{
+public:
+    DataStreamComms() = default;
+    DataStreamComms(const DataStreamComms&) = delete;
+
+    /** Registers the "mvstudio_data" comm target of the kernel */
+    void registerTarget(xeus::xcomm_manager& manager);
+
+    /** Removes a comm from its close handler, it is destroyed after the handler returned */
+    void remove(const xeus::xguid& id);
+
+    /** Destroys all comms */
+    void clear();
+
+private:
+    std::map<xeus::xguid, std::unique_ptr<DataStreamComm>>  _openComms = {};
+    std::vector<std::unique_ptr<DataStreamComm>>            _closedComms = {};  /** Destroyed when the next comm opens */
+};
@@ -0,0 +1,114 @@
+#include "DatasetHandle.h"
+
+#include "BindingUtils.h"
+
+#include <ClusterData/ClusterData.h>
+#include <CoreInterface.h>
+#include <DataHierarchyItem.h>
+#include <ImageData/ImageData.h>
+#include <PointData/PointData.h>
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <QString>
+
+#include <stdexcept>
+#include <string>
+
+namespace py = pybind11;
+
+DatasetHandle::DatasetHandle(const std::string& guid)
+{
+    const QString id = QString::fromStdString(guid);
+
+    // an item guid or a dataset guid, both are looked up directly
+    mv::DataHierarchyItem* item = mv::dataHierarchy().getItem(id);
+    if (!item) {
+        if (const auto dataset = mv::data().getDataset(id); dataset.isValid())
+            item = &dataset->getDataHierarchyItem();
+    }
+
+    if (!item)
+        throw py::value_error("DatasetHandle: no dataset or data hierarchy item with id " + guid);
+
+    _dataset    = item->getDataset();
+    _datasetId  = _dataset->getId().toStdString();
+    _itemId     = item->getId().toStdString();
+    _typeName   = _dataset->getDataType().getTypeString().toStdString();
+    _rawName    = _dataset->getRawDataName().toStdString();
+
+    if (const auto datatype = _dataset->getDataType(); datatype == ImageType)
+        _dataType = mvstudio_core::Image;
+    else if (datatype == ClusterType)
+        _dataType = mvstudio_core::Cluster;
+    else if (datatype == PointType)
+        _dataType = mvstudio_core::Points;
+}
+
+void DatasetHandle::ensureValid() const
+{
+    if (!_dataset.isValid())
+        throw py::value_error("DatasetHandle: dataset " + _datasetId + " is no longer available");
+}
+
+std::string DatasetHandle::getName() const
+{
+    ensureValid();
+    return _dataset->getGuiName().toStdString();
+}
+
+std::uint64_t DatasetHandle::getNumPoints() const
+{
+    ensureValid();
+
+    if (_dataType != mvstudio_core::Points)
+        return 0;
+
+    return mv::Dataset<Points>(_dataset)->getNumPoints();
+}
+
+std::uint64_t DatasetHandle::getNumDimensions() const
+{
+    ensureValid();
+
+    if (_dataType != mvstudio_core::Points)
+        return 0;
+
+    return mv::Dataset<Points>(_dataset)->getNumDimensions();
+}
+
+std::uint64_t DatasetHandle::getRawSize() const
+{
+    ensureValid();
+    return _dataset->getRawDataSize();
+}
+
+// =============================================================================
+// ManiVault embedding module 
+// =============================================================================
+
+namespace mvstudio_core {
+    void register_dataset_handle(pybind11::module_& m)
+    {
+        py::class_<DatasetHandle>(m, "DatasetHandle")
+            .def(py::init([](const std::string& guid) {
+                return run_on_main_thread([&]() { return DatasetHandle(guid); });
+            }), py::arg("guid"))
+            .def_property_readonly("id", &DatasetHandle::getDatasetId)
+            .def_property_readonly("item_id", &DatasetHandle::getItemId)
+            .def_property_readonly("type", &DatasetHandle::getDataType)
+            .def_property_readonly("type_name", &DatasetHandle::getTypeName)
+            .def_property_readonly("rawname", &DatasetHandle::getRawName)
+            .def_property_readonly("name", on_main_thread(&DatasetHandle::getName))
+            .def_property_readonly("numpoints", on_main_thread(&DatasetHandle::getNumPoints))
+            .def_property_readonly("numdimensions", on_main_thread(&DatasetHandle::getNumDimensions))
+            .def_property_readonly("rawsize", on_main_thread(&DatasetHandle::getRawSize))
+            .def_property_readonly("valid", on_main_thread(&DatasetHandle::isValid))
+            .def("__repr__", [](const DatasetHandle& handle) {
+                return "DatasetHandle(" + handle.getDatasetId() + ", " + handle.getTypeName() + ")";
+            });
+    }
+
+} // namespace mvstudio_core
@@ -0,0 +1,58 @@
+#pragma once
+
+#include "MVData.h"
+
+#include <Dataset.h>
+#include <Set.h>
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <cstdint>
+#include <string>
+
+/**
+ * Dataset handle
+ *
+ * Wraps a resolved ManiVault dataset for use from python.
+ * The dataset is looked up once on construction, by item or dataset guid, and metadata that
+ * does not change over the lifetime of a dataset is cached.
+ * Other getters query the held dataset directly, which avoids
+ * the guid conversion and hierarchy lookup of the free functions
+ * in MVData.h.
+ */
+class DatasetHandle
+{
+public:
+    DatasetHandle() = delete;
+    explicit DatasetHandle(const std::string& guid);
+
+    const std::string& getDatasetId() const { return _datasetId; }
+    const std::string& getItemId() const { return _itemId; }
+    const std::string& getTypeName() const { return _typeName; }
+    const std::string& getRawName() const { return _rawName; }
+    mvstudio_core::DataItemType getDataType() const { return _dataType; }
+
+    bool isValid() const { return _dataset.isValid(); }
+
+    std::string getName() const;
+    std::uint64_t getNumPoints() const;
+    std::uint64_t getNumDimensions() const;
+    std::uint64_t getRawSize() const;
+
+private:
+    void ensureValid() const;
+
+private:
+    mv::Dataset<mv::DatasetImpl>    _dataset = {};
+    std::string                     _datasetId = {};
+    std::string                     _itemId = {};
+    std::string                     _typeName = {};
+    std::string                     _rawName = {};
+    mvstudio_core::DataItemType     _dataType = mvstudio_core::NOT_IMPLEMENTED;
+};
+
+namespace mvstudio_core {
+    void register_dataset_handle(pybind11::module_& m);
+}
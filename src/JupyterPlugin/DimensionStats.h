@@ -0,0 +1,194 @@
+#pragma once
+
+#include <algorithm>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <limits>
+#include <vector>
+
+#ifdef _OPENMP
+#include <omp.h>
+#endif
+
+// Per-dimension summary statistics
+// Partial results of several row ranges can be merged, 
+// see Chan et al. "Updating Formulae and a Pairwise Algorithm for Computing Sample Variances"
+struct DimensionStats
+{
+    explicit DimensionStats(size_t numDims) :
+        count(numDims, 0),
+        min(numDims, std::numeric_limits<double>::infinity()),
+        max(numDims, -std::numeric_limits<double>::infinity()),
+        mean(numDims, 0.0),
+        m2(numDims, 0.0)
+    {
+    }
+
+    void add(size_t dim, double value)
+    {
+        if (!std::isfinite(value))
+            return;
+
+        count[dim]++;
+        min[dim] = std::min(min[dim], value);
+        max[dim] = std::max(max[dim], value);
+
+        const double delta = value - mean[dim];
+        mean[dim] += delta / static_cast<double>(count[dim]);
+        m2[dim] += delta * (value - mean[dim]);
+    }
+
+    void merge(const DimensionStats& other)
+    {
+        for (size_t dim = 0; dim < count.size(); ++dim) {
+            if (other.count[dim] == 0)
+                continue;
+
+            const double n_a    = static_cast<double>(count[dim]);
+            const double n_b    = static_cast<double>(other.count[dim]);
+            const double n      = n_a + n_b;
+            const double delta  = other.mean[dim] - mean[dim];
+
+            mean[dim]   += delta * n_b / n;
+            m2[dim]     += other.m2[dim] + delta * delta * n_a * n_b / n;
+            count[dim]  += other.count[dim];
+            min[dim]    = std::min(min[dim], other.min[dim]);
+            max[dim]    = std::max(max[dim], other.max[dim]);
+        }
+    }
+
+    // Population standard deviation, NaN for dimensions without finite values
+    std::vector<double> stddev() const
+    {
+        std::vector<double> result(count.size(), std::numeric_limits<double>::quiet_NaN());
+        for (size_t dim = 0; dim < count.size(); ++dim) {
+            if (count[dim] > 0)
+                result[dim] = std::sqrt(m2[dim] / static_cast<double>(count[dim]));
+        }
+        return result;
+    }
+
+    // Dimensions without finite values have NaN min, max and mean instead of the initial values
+    void setEmptyToNaN()
+    {
+        constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+        for (size_t dim = 0; dim < count.size(); ++dim) {
+            if (count[dim] > 0)
+                continue;
+
+            min[dim]    = nan;
+            max[dim]    = nan;
+            mean[dim]   = nan;
+        }
+    }
+
+    std::vector<std::uint64_t> count;
+    std::vector<double> min;
+    std::vector<double> max;
+    std::vector<double> mean;
+    std::vector<double> m2;     // sum of squared differences from the mean
+};
+
+// Number of row blocks that are processed in parallel, at most one per OpenMP thread
+// Each block has its own partial result, so the scratch memory grows with the number of threads and not the rows.
+// Blocks are contiguous in memory so that each thread streams through its own part of the data
+inline std::int64_t numDimensionStatsBlocks(size_t numRows)
+{
+    constexpr size_t minRowsPerBlock = 4096;
+#ifdef _OPENMP
+    const auto maxBlocks = static_cast<size_t>(std::max(1, omp_get_max_threads()));
+#else
+    constexpr size_t maxBlocks = 1;
+#endif
+    return static_cast<std::int64_t>(std::clamp<size_t>(numRows / minRowsPerBlock, 1, maxBlocks));
+}
+
+// data is the row-major (num_points x numDimensions) point data, 
+// rowIndices selects the rows of a subset - all rows [0, numRows) are used if it is empty
+template<typename T>
+DimensionStats compute_dimension_stats_impl(const T* data, size_t numDimensions, const std::vector<std::uint32_t>& rowIndices, size_t numRows, const std::vector<std::uint32_t>& dims)
+{
+    const std::int64_t numBlocks = numDimensionStatsBlocks(numRows);
+    std::vector<DimensionStats> blockStats(numBlocks, DimensionStats(dims.size()));
+
+#pragma omp parallel for
+    for (std::int64_t block = 0; block < numBlocks; ++block) {
+        const size_t rowBegin = numRows * block / numBlocks;
+        const size_t rowEnd   = numRows * (block + 1) / numBlocks;
+        auto& stats           = blockStats[block];
+
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            const size_t row = rowIndices.empty() ? i : rowIndices[i];
+            const T* rowData = data + row * numDimensions;
+
+            for (size_t d = 0; d < dims.size(); ++d)
+                stats.add(d, static_cast<double>(static_cast<float>(rowData[dims[d]])));
+        }
+    }
+
+    DimensionStats result(dims.size());
+    for (const auto& stats : blockStats)
+        result.merge(stats);
+
+    return result;
+}
+
+// Returns a (dims.size() x numBins) row-major histogram with equal width bins between min and max of each dimension
+template<typename T>
+std::vector<std::uint64_t> compute_dimension_histograms_impl(const T* data, size_t numDimensions, const std::vector<std::uint32_t>& rowIndices, size_t numRows, const std::vector<std::uint32_t>& dims, const DimensionStats& stats, size_t numBins)
+{
+    const std::int64_t numBlocks = numDimensionStatsBlocks(numRows);
+    std::vector<std::vector<std::uint64_t>> blockHistograms(numBlocks, std::vector<std::uint64_t>(dims.size() * numBins, 0));
+
+#pragma omp parallel for
+    for (std::int64_t block = 0; block < numBlocks; ++block) {
+        const size_t rowBegin = numRows * block / numBlocks;
+        const size_t rowEnd   = numRows * (block + 1) / numBlocks;
+        auto& histogram       = blockHistograms[block];
+
+        for (size_t i = rowBegin; i < rowEnd; ++i) {
+            const size_t row = rowIndices.empty() ? i : rowIndices[i];
+            const T* rowData = data + row * numDimensions;
+
+            for (size_t d = 0; d < dims.size(); ++d) {
+                const double value = static_cast<double>(static_cast<float>(rowData[dims[d]]));
+
+                if (!std::isfinite(value))
+                    continue;
+
+                const double range = stats.max[d] - stats.min[d];
+                size_t bin = range > 0 ? static_cast<size_t>((value - stats.min[d]) / range * static_cast<double>(numBins)) : 0;
+                bin = std::min(bin, numBins - 1);   // the maximum falls in the last bin
+
+                histogram[d * numBins + bin]++;
+            }
+        }
+    }
+
+    std::vector<std::uint64_t> result(dims.size() * numBins, 0);
+    for (const auto& histogram : blockHistograms)
+        std::transform(result.begin(), result.end(), histogram.begin(), result.begin(), std::plus<>());
+
+    return result;
+}
+
+// Returns the (numDims x (numBins + 1)) row-major edges of the bins of compute_dimension_histograms_impl,
+// NaN for dimensions without finite values
+inline std::vector<double> dimension_bin_edges(const DimensionStats& stats, size_t numBins)
+{
+    const size_t numDims = stats.count.size();
+    std::vector<double> edges(numDims * (numBins + 1), std::numeric_limits<double>::quiet_NaN());
+
+    for (size_t d = 0; d < numDims; ++d) {
+        if (stats.count[d] == 0)
+            continue;
+
+        const double width = (stats.max[d] - stats.min[d]) / static_cast<double>(numBins);
+        for (size_t b = 0; b <= numBins; ++b)
+            edges[d * (numBins + 1) + b] = stats.min[d] + width * static_cast<double>(b);
+    }
+
+    return edges;
+}
@@ -0,0 +1,17 @@
+#include "InterpreterGil.h"
+
+namespace py = pybind11;
+
+std::shared_ptr<py::subinterpreter> current_interpreter()
+{
+    return std::make_shared<py::subinterpreter>(py::subinterpreter::current());
+}
+
+interpreter_gil_acquire::interpreter_gil_acquire(const py::subinterpreter& interpreter)
+{
+    // the main interpreter keeps the thread states pybind11 associates with each thread
+    if (interpreter.id() == py::subinterpreter::main().id())
+        _mainGil.emplace();
+    else
+        _subinterpreter.emplace(interpreter);
+}
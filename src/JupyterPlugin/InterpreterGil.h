@@ -0,0 +1,28 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#include <pybind11/subinterpreter.h>
+#define slots Q_SLOTS
+
+#include <memory>
+#include <optional>
+
+// Handle to the python interpreter of the calling thread, which holds its GIL
+// This is the main interpreter, or the subinterpreter of an additional kernel
+std::shared_ptr<pybind11::subinterpreter> current_interpreter();
+
+// Acquires the GIL of the given interpreter on any thread
+// For a subinterpreter the thread is given a thread state of that interpreter for the lifetime of the guard
+class interpreter_gil_acquire
+{
+public:
+    explicit interpreter_gil_acquire(const pybind11::subinterpreter& interpreter);
+
+    interpreter_gil_acquire(const interpreter_gil_acquire&) = delete;
+    interpreter_gil_acquire& operator=(const interpreter_gil_acquire&) = delete;
+
+private:
+    std::optional<pybind11::gil_scoped_acquire>             _mainGil = {};
+    std::optional<pybind11::subinterpreter_scoped_activate> _subinterpreter = {};
+};
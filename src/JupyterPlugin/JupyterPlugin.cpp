@@ -1,12 +1,22 @@
 #include "JupyterPlugin.h"
 
+#include <QCoreApplication>
 #include <QDebug>
 #include <QDir>
+#include <QElapsedTimer>
+#include <QEvent>
+#include <QFileInfo>
 #include <QStandardPaths>
+#include <QThread>
 
+#include <algorithm>
+#include <atomic>
+#include <cctype>
 #include <exception>
+#include <filesystem>
 #include <format>
-#include <fstream>
+#include <mutex>
+#include <optional>
 #include <set>
 #include <string>
 #include <stdexcept>
@@ -21,8 +31,15 @@
 
 #include <Application.h>
 
+#include "AsyncTransfer.h"
+#include "DatasetHandle.h"
+#include "KernelTrace.h"
 #include "MVData.h"
+#include "OutputCoalescer.h"
 #include "PythonBuildVersion.h"
+#include "ScriptCache.h"
+#include "ScriptProgress.h"
+#include "SubinterpreterConfig.h"
 #include "XeusKernel.h"
 
 Q_PLUGIN_METADATA(IID "studio.manivault.JupyterPlugin")
@@ -33,6 +50,10 @@ PYBIND11_EMBEDDED_MODULE(mvstudio_core, m, py::multiple_interpreters::per_interp
     m.doc() = "Provides access to low level ManiVaultStudio core functions";
     m.attr("__version__") = std::format("{}.{}.{}", pythonBridgeVersionMajor, pythonBridgeVersionMinor, pythonBridgeVersionPatch);
     mvstudio_core::register_mv_data_items(m);
+    mvstudio_core::register_dataset_handle(m);
+    mvstudio_core::register_output_coalescer(m);
+    mvstudio_core::register_kernel_trace(m);
+    mvstudio_core::register_script_progress(m);
     mvstudio_core::register_mv_core_module(m);
 }
 
@@ -45,8 +66,176 @@ namespace
             auto pyModMv = py::module::import("mvstudio_core");
         }
     }
+
+    void execScript(const QString& scriptPath, const py::object& globals)
+    {
+        py::module_::import("builtins").attr("exec")(compileScript(scriptPath), globals);
+    }
+
+    // Makes the progress current on this thread while a script runs, and finishes it afterwards
+    class ScopedScriptProgress
+    {
+    public:
+        ScopedScriptProgress(std::shared_ptr<ScriptProgress> progress, std::size_t run) : _progress(std::move(progress)), _run(run) { ScriptProgress::setCurrent(_progress.get(), _run); }
+        ~ScopedScriptProgress() { ScriptProgress::setCurrent(nullptr); _progress->finish(_run); }
+
+    private:
+        std::shared_ptr<ScriptProgress> _progress;
+        std::size_t                     _run;
+    };
+
+    // Removes user-defined globals, keeps __name__, __builtins__ and other special attributes
+    void clearGlobals(const py::dict& globals)
+    {
+        std::set<std::string> toRemove;
+        for (auto& [key, _] : globals) {
+
+            if (std::string globalName = py::str(key);
+                !globalName.empty() && globalName[0] != '_') {
+                toRemove.insert(globalName);
+            }
+        }
+
+        for (const auto& key : toRemove) {
+            globals.attr("pop")(key);
+        }
+    }
+
+    // sys.argv as for running the script from the command line
+    py::list scriptArgs(const QString& scriptPath, const QStringList& args)
+    {
+        auto pyArgs = py::list();
+        pyArgs.append(py::cast(QFileInfo(scriptPath).fileName().toStdString()));      // add file name
+        for (const auto& arg : args) {
+            pyArgs.append(py::cast(arg.toStdString()));                               // add arguments
+        }
+        return pyArgs;
+    }
+
+    // Replaces sys.argv of the main interpreter by a list that shows each thread its own arguments.
+    // Scripts set theirs with set_thread_args, such as argparse reads them, while notebook cells
+    // and other threads see the original sys.argv, which stays as it is in the list itself
+    constexpr const char* scriptArgvSource = R"(
+import sys
+import threading
+
+class ScriptArgv(list):
+    def __init__(self, argv):
+        super().__init__(argv)
+        self._local = threading.local()
+
+    def set_thread_args(self, args):
+        self._local.args = list(args)
+
+    def clear_thread_args(self):
+        self._local.args = None
+
+    def _args(self):
+        args = getattr(self._local, "args", None)
+        return list(list.__iter__(self)) if args is None else args
+
+    def __getitem__(self, index): return self._args()[index]
+    def __len__(self): return len(self._args())
+    def __iter__(self): return iter(self._args())
+    def __reversed__(self): return reversed(self._args())
+    def __contains__(self, value): return value in self._args()
+    def __eq__(self, other): return self._args() == other
+    def __ne__(self, other): return self._args() != other
+    def __add__(self, other): return self._args() + other
+    def __repr__(self): return repr(self._args())
+    def index(self, *args): return self._args().index(*args)
+    def count(self, value): return self._args().count(value)
+    def copy(self): return list(self._args())
+
+    __hash__ = None
+
+sys.argv = ScriptArgv(sys.argv)
+)";
+
+    void installScriptArgv()
+    {
+        py::exec(scriptArgvSource, py::dict());
+    }
+
+    // sys.argv of the main interpreter, installed again if something replaced it
+    py::object scriptArgv()
+    {
+        if (const py::object argv = py::module_::import("sys").attr("argv"); py::hasattr(argv, "set_thread_args"))
+            return argv;
+
+        installScriptArgv();
+        return py::module_::import("sys").attr("argv");
+    }
+
+    // Waits for the tasks of the pool, which may wait for the GUI thread to access ManiVault
+    void waitForPool(QThreadPool* pool)
+    {
+        if (!pool)
+            return;
+
+        while (!pool->waitForDone(10)) {
+            if (auto* app = QCoreApplication::instance())
+                QCoreApplication::sendPostedEvents(app, QEvent::MetaCall);
+        }
+    }
+
+    std::unordered_set<std::string> loadedModuleNames()
+    {
+        std::unordered_set<std::string> moduleNames;
+        for (const py::dict loadedModules = py::module::import("sys").attr("modules");
+            auto& [key, _] : loadedModules) {
+            moduleNames.insert(py::str(key));
+        }
+        return moduleNames;
+    }
+
+    // Removes the connection files of additional kernels next to the main one, <stem>-<n><extension>,
+    // including those left behind by a session that did not stop its kernels
+    void removeAdditionalConnectionFiles(const std::filesystem::path& mainPath)
+    {
+        const std::string prefix    = mainPath.stem().string() + "-";
+        const std::string extension = mainPath.extension().string();
+
+        std::error_code ec;
+        for (const auto& entry : std::filesystem::directory_iterator(mainPath.parent_path(), ec)) {
+            const std::filesystem::path& path = entry.path();
+            const std::string stem = path.stem().string();
+
+            if (path.extension() != extension || !stem.starts_with(prefix) || stem.size() == prefix.size())
+                continue;
+
+            if (std::all_of(stem.begin() + prefix.size(), stem.end(), [](unsigned char c) { return std::isdigit(c); }))
+                std::filesystem::remove(path, ec);
+        }
+    }
 }
 
+// The runs of a script, each run is taken once by a worker or cancelled
+struct ScriptBatch
+{
+    ScriptBatch(const QList<QStringList>& argsPerRunIn, std::shared_ptr<ScriptProgress> progressIn) :
+        argsPerRun(argsPerRunIn),
+        progress(std::move(progressIn))
+    {
+    }
+
+    std::size_t numRuns() const { return static_cast<std::size_t>(argsPerRun.size()); }
+
+    // The next run to execute, numRuns() once all runs are taken or cancelled
+    std::size_t takeRun() { return std::min(nextRun++, numRuns()); }
+
+    // Takes the remaining runs without executing them and finishes their progress
+    void cancel()
+    {
+        for (std::size_t run = nextRun++; run < numRuns(); run = nextRun++)
+            progress->finish(run);
+    }
+
+    const QList<QStringList>                argsPerRun;
+    const std::shared_ptr<ScriptProgress>   progress;
+    std::atomic<std::size_t>                nextRun = 0;
+};
+
 JupyterPlugin::JupyterPlugin(const mv::plugin::PluginFactory* factory) :
     mv::plugin::ViewPlugin(factory)
 {
@@ -54,20 +243,112 @@ JupyterPlugin::JupyterPlugin(const mv::plugin::PluginFactory* factory) :
 
 JupyterPlugin::~JupyterPlugin()
 {
+    waitForScripts();
+    waitForAsyncTransfers();
+    stopWarmUp();
+    stopAdditionalKernels();
+
+    // finalizing the interpreter needs the GIL
+    _releasedGil.reset();
+
+    if (!_xeusKernel)
+        return;
+
+    // The interpreter re-acquires the GIL for the GUI thread when it is destroyed,
+    // which needs to happen before the python interpreter is finalized
     _xeusKernel->stopKernel();
+    _xeusKernel.reset();
 }
 
 void JupyterPlugin::init()
 {
-    // start the interpreter and keep it alive
-    _mainPyInterpreter = std::make_unique<py::scoped_interpreter>();
-    importMvModule();
+    {
+        // start the interpreter and keep it alive
+        KernelTrace::ScopedPhase phase("start interpreter");
+        _mainPyInterpreter = std::make_unique<py::scoped_interpreter>();
+    }
+
+    {
+        KernelTrace::ScopedPhase phase("import mvstudio_core");
+        importMvModule();
+    }
+
+    // scripts pass their arguments without changing sys.argv for the kernel
+    installScriptArgv();
 
     // save global base state
-    for (const py::dict loadedModules = py::module::import("sys").attr("modules");
-        auto& [key, _] : loadedModules) {
-        _baseModules.insert(py::str(key));
+    _baseModules = loadedModuleNames();
+
+    _scriptPool = std::make_unique<QThreadPool>();
+    _scriptPool->setObjectName("JupyterPluginScripts");
+    _scriptPool->setMaxThreadCount(QThread::idealThreadCount());
+
+    // scripts in the main interpreter share sys.modules, so they run one at a time
+    _mainScriptPool = std::make_unique<QThreadPool>();
+    _mainScriptPool->setObjectName("JupyterPluginMainScripts");
+    _mainScriptPool->setMaxThreadCount(1);
+
+    // asynchronous transfers copy data, which is memory bound rather than limited by the GIL
+    _asyncPool = std::make_unique<QThreadPool>();
+    _asyncPool->setObjectName("JupyterPluginAsync");
+    _asyncPool->setMaxThreadCount(QThread::idealThreadCount());
+    mvstudio_core::set_async_pool(_asyncPool.get());
+
+    // Scripts and the warm-up run on worker threads, the GUI thread takes
+    // the GIL back when it starts the notebook, see startJupyterNotebook
+    _releasedGil = std::make_unique<py::gil_scoped_release>();
+
+    if (!_warmUpModules.empty())
+        _warmUpThread = std::thread([this]() { warmUp(); });
+}
+
+void JupyterPlugin::setWarmUpModules(const QStringList& modules)
+{
+    _warmUpModules.clear();
+    for (const auto& module : modules)
+        _warmUpModules.push_back(module.toStdString());
+}
+
+void JupyterPlugin::warmUp()
+{
+    KernelTrace::ScopedPhase warmUpPhase("warm-up");
+    py::gil_scoped_acquire acquire;
+
+    for (const auto& module : _warmUpModules) {
+        if (_stopWarmUp)
+            break;
+
+        KernelTrace::ScopedPhase phase("import " + module);
+        try {
+            py::module_::import(module.c_str());
+        }
+        catch (const py::error_already_set& e) {
+            qWarning() << "JupyterPlugin::warmUp: cannot import" << module.c_str() << ":" << e.what();
+        }
     }
+
+    // keep the warmed up modules when cleaning up after scripts
+    _baseModules.merge(loadedModuleNames());
+}
+
+void JupyterPlugin::stopWarmUp()
+{
+    if (!_warmUpThread.joinable())
+        return;
+
+    // the warm-up finishes its current import, which needs the GIL
+    _stopWarmUp = true;
+    if (PyGILState_Check()) {
+        py::gil_scoped_release release;
+        _warmUpThread.join();
+    }
+    else
+        _warmUpThread.join();
+}
+
+void JupyterPlugin::setTransferBudget(qulonglong bytes)
+{
+    mvstudio_core::set_transfer_budget(bytes);
 }
 
 void JupyterPlugin::startJupyterNotebook()
@@ -77,39 +358,101 @@ void JupyterPlugin::startJupyterNotebook()
         return;
     }
 
+    // Reacquire the GIL, a running warm-up continues once the kernel releases it
+    _releasedGil.reset();
+
+    // from now on scripts leave sys.modules alone, cells may use the modules they import
+    _kernelStarted = true;
+
     _xeusKernel = std::make_unique<XeusKernel>();
-    _xeusKernel->startKernel(_connectionFilePath, getVersion().getVersionString(), _kernelWorkingDirectory);
+    _xeusKernel->startKernel(_connectionFilePath, getVersion().getVersionString(), _kernelWorkingDirectory, _useIpcTransport);
+
+    startAdditionalKernels();
 }
 
-void JupyterPlugin::cleanGlobalNamespace() const
+std::string JupyterPlugin::additionalConnectionFilePath(int kernel) const
 {
-    // Clear user-defined globals (keep builtins)
-    py::dict pythonGlobals = py::module_::import("__main__").attr("__dict__");
+    const std::filesystem::path mainPath = _connectionFilePath;
+    return (mainPath.parent_path() / std::format("{}-{}{}", mainPath.stem().string(), kernel, mainPath.extension().string())).string();
+}
 
-    // Remove everything except builtins and special attributes
-    std::set<std::string> toRemove;
-    for (auto& [key, _] : pythonGlobals) {
+void JupyterPlugin::startAdditionalKernels()
+{
+    // jupyter hands out every connection file it finds, also those of kernels that no longer run
+    removeAdditionalConnectionFiles(_connectionFilePath);
 
-        if (std::string globalName = py::str(key);
-            !globalName.empty() && globalName[0] != '_') {  // keep __name__, __builtins__, etc.
-            toRemove.insert(globalName);
-        }
+    for (int kernel = 1; kernel <= _numAdditionalKernels; ++kernel) {
+        KernelTrace::ScopedPhase phase(std::format("start kernel {}", kernel));
+
+        auto xeusKernel = std::make_unique<XeusKernel>(/*ownInterpreter*/ true);
+        xeusKernel->startKernel(additionalConnectionFilePath(kernel), getVersion().getVersionString(), _kernelWorkingDirectory, _useIpcTransport);
+        _additionalKernels.push_back(std::move(xeusKernel));
+    }
+}
+
+void JupyterPlugin::stopAdditionalKernels()
+{
+    for (auto& xeusKernel : _additionalKernels)
+        xeusKernel->stopKernel();
+
+    // ends the subinterpreters
+    _additionalKernels.clear();
+
+    // jupyter would otherwise try to connect to these kernels next time
+    removeAdditionalConnectionFiles(_connectionFilePath);
+}
+
+void JupyterPlugin::setModuleRetention(int policy, const QStringList& retainedModules)
+{
+    _moduleRetention = static_cast<ModuleRetention>(policy);
+
+    _retainedModules.clear();
+    for (const auto& module : retainedModules)
+        _retainedModules.insert(module.trimmed().toStdString());
+}
+
+bool JupyterPlugin::retainModule(const std::string& moduleName, const py::handle& module, const QString& scriptDirectory) const
+{
+    switch (_moduleRetention) {
+    case ModuleRetention::Allowlist:
+        return _retainedModules.contains(moduleName.substr(0, moduleName.find('.')));
+
+    case ModuleRetention::OutsideScriptDirectory: {
+        // built-in and namespace modules have no file
+        const py::object moduleFile = py::getattr(module, "__file__", py::none());
+        if (moduleFile.is_none() || scriptDirectory.isEmpty())
+            return true;
+
+        const QString modulePath = QDir::cleanPath(QFileInfo(QString::fromStdString(py::str(moduleFile))).absoluteFilePath());
+        return !modulePath.startsWith(scriptDirectory + "/");
     }
 
-    for (const auto& key : toRemove) {
-        pythonGlobals.attr("pop")(key);
+    case ModuleRetention::ReloadAll:
+    default:
+        return false;
     }
+}
 
-    // Clean up modules for fresh start
+void JupyterPlugin::unloadScriptModules(const QString& scriptPath, const std::unordered_set<std::string>& modulesBeforeRun) const
+{
+    // Clean up modules for fresh start, expensive imports may be kept for the next script
+    const QString scriptDirectory = QDir::cleanPath(QFileInfo(scriptPath).absolutePath());
+
+    std::vector<std::string> toUnload;
     for (const py::dict loadedModules = py::module::import("sys").attr("modules");
-        auto& [key, _] : loadedModules) {
+        auto& [key, module] : loadedModules) {
 
         if (std::string moduleName = py::str(key);
-            !_baseModules.contains(moduleName)) {
-            loadedModules.attr("pop")(moduleName, py::none());
+            !_baseModules.contains(moduleName) && !modulesBeforeRun.contains(moduleName) && !retainModule(moduleName, module, scriptDirectory)) {
+            toUnload.push_back(std::move(moduleName));
         }
     }
 
+    const py::dict loadedModules = py::module::import("sys").attr("modules");
+    for (const auto& moduleName : toUnload) {
+        loadedModules.attr("pop")(moduleName, py::none());
+    }
+
     // Run garbage collection
     const py::module gc = py::module::import("gc");
     const auto gcResult = gc.attr("collect")();
@@ -118,55 +461,175 @@ void JupyterPlugin::cleanGlobalNamespace() const
 // ReSharper disable once CppMemberFunctionMayBeStatic
 // Cannot be static since we want to apply Q_INVOKABLE 
 void JupyterPlugin::runScriptWithArgs(const QString& scriptPath, const QStringList& args) const
+{
+    runScriptBatch(scriptPath, { args });
+}
+
+void JupyterPlugin::runScriptBatch(const QString& scriptPath, const QList<QStringList>& argsPerRun) const
 {
     if (!Py_IsInitialized()) {
-        qWarning() << "JupyterPlugin::runScriptWithArgs: Script not executed - interpreter is not initialized";
+        qWarning() << "JupyterPlugin::runScriptBatch: Script not executed - interpreter is not initialized";
         return;
     }
 
-    py::gil_scoped_acquire acquire;
-    importMvModule();
-
-    // Load the script from file
-    std::ifstream file(scriptPath.toStdString());
-    const std::string scriptCode(
-        std::istreambuf_iterator<char>(file),
-        std::istreambuf_iterator<char>{}
-    );
-
-    try {
-        // Set sys.argv
-        auto pyArgs = py::list();
-        pyArgs.append(py::cast(QFileInfo(scriptPath).fileName().toStdString()));      // add file name
-        for (const auto& arg : args) {
-            pyArgs.append(py::cast(arg.toStdString()));                               // add arguments
-        }
-        py::module_::import("sys").attr("argv") = pyArgs;
+    if (argsPerRun.isEmpty())
+        return;
 
-        // Execute the script in __main__'s context
-        const py::module_ mainModule   = py::module_::import("__main__");
-        const py::object mainNamespace = mainModule.attr("__dict__");
+    // Shown as one background task, the runs execute on worker threads
+    auto batch = std::make_shared<ScriptBatch>(argsPerRun, std::make_shared<ScriptProgress>(QFileInfo(scriptPath).fileName(), argsPerRun.size()));
 
-        py::exec(scriptCode, mainNamespace);
+    {
+        // waitForScripts cancels the runs that did not start yet
+        std::scoped_lock lock(_scriptBatchesMutex);
+        std::erase_if(_scriptBatches, [](const std::weak_ptr<ScriptBatch>& scriptBatch) { return scriptBatch.expired(); });
+        _scriptBatches.push_back(batch);
+    }
 
-        cleanGlobalNamespace();
+    if (_scriptsInSubinterpreters) {
+        runScriptsInSubinterpreters(scriptPath, std::move(batch));
+        return;
     }
-    catch (const py::error_already_set& e) {
-        qWarning() << QStringLiteral("Python error (probably from script):");
-        qWarning() << e.what();
+
+    // one run at a time, modules kept by the retention policy are reused by the next run
+    for (std::size_t i = 0; i < batch->numRuns(); ++i) {
+        _mainScriptPool->start([this, scriptPath, batch]() {
+            const std::size_t run = batch->takeRun();
+            if (run == batch->numRuns())
+                return;
+
+            ScopedScriptProgress scopedProgress(batch->progress, run);
+
+            py::gil_scoped_acquire acquire;
+            importMvModule();
+
+            // Each run has its own globals as if it were __main__, the __main__ module
+            // belongs to the kernel and notebook cells may run while the script does
+            py::dict globals;
+            globals["__name__"]     = "__main__";
+            globals["__builtins__"] = py::module_::import("builtins");
+
+            // Once notebook cells can run, the modules that were loaded before the run may be used by them,
+            // only those that the script adds are subject to the retention policy
+            const std::unordered_set<std::string> modulesBeforeRun = _kernelStarted ? loadedModuleNames() : std::unordered_set<std::string>{};
+
+            // sys.argv shows the arguments to this thread only, see installScriptArgv
+            const py::object argv = scriptArgv();
+
+            try {
+                argv.attr("set_thread_args")(scriptArgs(scriptPath, batch->argsPerRun[static_cast<qsizetype>(run)]));
+
+                execScript(scriptPath, globals);
+            }
+            catch (const py::error_already_set& e) {
+                qWarning() << QStringLiteral("Python error (probably from script):");
+                qWarning() << e.what();
+            }
+            catch (const std::runtime_error& e) {
+                qWarning() << QStringLiteral("std::runtime_error:");
+                qWarning() << e.what();
+            }
+            catch (const std::exception& e) {
+                qWarning() << QStringLiteral("std::exception:");
+                qWarning() << e.what();
+            }
+            catch (...) {
+                qWarning() << QStringLiteral("Python error: unknown");
+            }
+
+            argv.attr("clear_thread_args")();
+            globals.clear();
+
+            unloadScriptModules(scriptPath, modulesBeforeRun);
+        });
     }
-    catch (const std::runtime_error& e) {
-        qWarning() << QStringLiteral("std::runtime_error:");
-        qWarning() << e.what();
+}
+
+void JupyterPlugin::runScriptsInSubinterpreters(const QString& scriptPath, std::shared_ptr<ScriptBatch> batch) const
+{
+    // Each worker runs in its own subinterpreter and takes the next run until all are done,
+    // such that runs on the same worker reuse the imports of the previous ones.
+    // The subinterpreters isolate the namespaces of the scripts, they do not run python code in parallel:
+    // they share the GIL, so the workers only overlap while a run releases it, e.g. in ManiVault transfers
+    const auto numWorkers       = std::min<std::size_t>(batch->numRuns(), static_cast<std::size_t>(std::max(1, _scriptPool->maxThreadCount())));
+    const auto numFailedWorkers = std::make_shared<std::atomic<std::size_t>>(0);
+
+    for (std::size_t worker = 0; worker < numWorkers; ++worker) {
+        _scriptPool->start([scriptPath, batch, numWorkers, numFailedWorkers]() {
+            // Created and ended on the worker, the GUI thread only queues the batch
+            std::optional<py::subinterpreter> interpreter;
+            try {
+                py::gil_scoped_acquire acquire;
+                interpreter.emplace(create_shared_gil_subinterpreter());
+            }
+            catch (const std::exception& e) {
+                qWarning() << "JupyterPlugin::runScriptsInSubinterpreters: cannot create subinterpreter:" << e.what();
+
+                // the runs are left to the other workers, unless none of them has a subinterpreter either
+                if (++*numFailedWorkers == numWorkers)
+                    batch->cancel();
+                return;
+            }
+
+            {
+                py::subinterpreter_scoped_activate activate(*interpreter);
+
+                for (std::size_t run = batch->takeRun(); run < batch->numRuns(); run = batch->takeRun()) {
+                    ScopedScriptProgress scopedProgress(batch->progress, run);
+
+                    try {
+                        importMvModule();
+                        // sys of the subinterpreter belongs to this worker alone
+                        py::module_::import("sys").attr("argv") = scriptArgs(scriptPath, batch->argsPerRun[static_cast<qsizetype>(run)]);
+
+                        // every run starts with empty globals in the __main__ of the subinterpreter
+                        const py::dict mainNamespace = py::module_::import("__main__").attr("__dict__");
+                        clearGlobals(mainNamespace);
+                        execScript(scriptPath, mainNamespace);
+                    }
+                    catch (const py::error_already_set& e) {
+                        qWarning() << "Python error in script" << scriptPath << ":";
+                        qWarning() << e.what();
+                    }
+                    catch (const std::exception& e) {
+                        qWarning() << "Error in script" << scriptPath << ":" << e.what();
+                    }
+                }
+            }
+
+            // ends the subinterpreter with all state of the script
+            interpreter.reset();
+        });
     }
-    catch (const std::exception& e) {
-        qWarning() << QStringLiteral("std::exception:");
-        qWarning() << e.what();
+}
+
+void JupyterPlugin::waitForScripts()
+{
+    // runs that did not start are dropped, which finishes their progress
+    {
+        std::scoped_lock lock(_scriptBatchesMutex);
+        for (const auto& scriptBatch : _scriptBatches) {
+            if (const auto batch = scriptBatch.lock())
+                batch->cancel();
+        }
+        _scriptBatches.clear();
     }
-    catch (...) {
-        qWarning() << QStringLiteral("Python error: unknown");
+
+    for (QThreadPool* pool : { _mainScriptPool.get(), _scriptPool.get() }) {
+        if (!pool)
+            continue;
+
+        pool->clear();
+        waitForPool(pool);
     }
+}
 
+void JupyterPlugin::waitForAsyncTransfers()
+{
+    // New *_async calls raise. The queued tasks are not dropped, since they hold python objects
+    // that can only be released with the GIL, all of them complete before the interpreter is destroyed
+    mvstudio_core::set_async_pool(nullptr);
+    waitForPool(_asyncPool.get());
+    _asyncPool.reset();
 }
 
 // =============================================================================
@@ -2,26 +2,55 @@
 
 #include <ViewPlugin.h>
 
+#include <atomic>
 #include <memory>
+#include <mutex>
+#include <thread>
 #include <unordered_set>
+#include <vector>
 
 #include <QString>
 #include <QStringList>
+#include <QThreadPool>
 
 #undef slots
 #include <pybind11/embed.h>
 #include <pybind11/pybind11.h>
 #define slots Q_SLOTS
 
+class ScriptProgress;
+struct ScriptBatch;
 class XeusKernel;
 using PyScopedInterpreterPtr = std::unique_ptr<pybind11::scoped_interpreter>;
 using PyModulePtr = std::unique_ptr<pybind11::module>;
+using PyGilReleasePtr = std::unique_ptr<pybind11::gil_scoped_release>;
 
 /**
  * Jupyter plugin class
  *
  * This view plugin class hosts a Xeus kernel and python interpreter.
  * We open this plugin via the jupyter launcher plugin.
+ * 
+ * Besides the kernel in the main interpreter, a number of additional kernels can be started,
+ * each in its own subinterpreter and with its own connection file (connection-<n>.json next to the main one).
+ * These give isolated namespaces, no parallelism: the subinterpreters share the GIL with the main interpreter,
+ * and only modules that support subinterpreters can be imported in them, see create_shared_gil_subinterpreter.
+ * 
+ * A script in the main interpreter runs with its own globals instead of those of __main__, which belong
+ * to the kernel, and they are removed afterwards. The modules it imported are removed according to the
+ * module retention policy, such that expensive imports can be reused. Once the kernel runs, this only applies
+ * to the modules that were not loaded before the script, the others may be used by notebook cells.
+ * The script arguments are shown as sys.argv to the script thread only, the kernel keeps its own.
+ * 
+ * Scripts run as background tasks, in the main interpreter on a worker thread, or optionally in fresh
+ * subinterpreters on a worker pool, such that scripts do not share state. These give isolated namespaces,
+ * no parallelism: the subinterpreters share the GIL, so python code of different scripts does not run
+ * at the same time, and modules without subinterpreter support (e.g. numpy) cannot be imported.
+ * The subinterpreters are created and ended on the pool workers.
+ * A batch of runs, e.g. one per selected dataset, shares one task and reuses the imports between runs.
+ * 
+ * On init, configured warm-up modules are imported on a background thread
+ * while the GUI thread does not hold the GIL, until the notebook is started.
  *
  * @authors B. van Lew, A. Vieth
  */
@@ -30,6 +59,14 @@ class JupyterPlugin : public mv::plugin::ViewPlugin
     Q_OBJECT
 
 public:
+    /** Which modules imported by a script are kept for the next script */
+    enum class ModuleRetention : int
+    {
+        ReloadAll = 0,              /** Remove all modules imported by the script */
+        Allowlist = 1,              /** Keep the packages in the retained modules list */
+        OutsideScriptDirectory = 2, /** Keep all modules that are not located in the directory of the script */
+    };
+
 
     /**
      * Constructor
@@ -43,6 +80,9 @@ public:
     Q_INVOKABLE void startJupyterNotebook();
     Q_INVOKABLE void runScriptWithArgs(const QString& scriptPath, const QStringList& args) const;
 
+    /** Runs the script once per entry of argsPerRun as one background task, e.g. for each of several selected datasets */
+    Q_INVOKABLE void runScriptBatch(const QString& scriptPath, const QList<QStringList>& argsPerRun) const;
+
     Q_INVOKABLE void setConnectionFilePath(const QString& scriptPath) {
         _connectionFilePath = scriptPath.toStdString();
     }
@@ -51,15 +91,60 @@ public:
         _kernelWorkingDirectory = kernelWorkingDirectory.toStdString();
     }
 
+    Q_INVOKABLE void setTransferBudget(qulonglong bytes);
+
+    Q_INVOKABLE void setUseIpcTransport(bool useIpc) {
+        _useIpcTransport = useIpc;
+    }
+
+    /** policy is a ModuleRetention, retainedModules are top-level package names for ModuleRetention::Allowlist */
+    Q_INVOKABLE void setModuleRetention(int policy, const QStringList& retainedModules);
+
+    Q_INVOKABLE void setRunScriptsInSubinterpreters(bool inSubinterpreters) {
+        _scriptsInSubinterpreters = inSubinterpreters;
+    }
+
+    Q_INVOKABLE void setNumAdditionalKernels(int numKernels) {
+        _numAdditionalKernels = numKernels;
+    }
+
+    /** Modules to import in the background on init, needs to be set before init */
+    Q_INVOKABLE void setWarmUpModules(const QStringList& modules);
+
 private:
-    void cleanGlobalNamespace() const;
+    void unloadScriptModules(const QString& scriptPath, const std::unordered_set<std::string>& modulesBeforeRun) const;
+    bool retainModule(const std::string& moduleName, const pybind11::handle& module, const QString& scriptDirectory) const;
+    void runScriptsInSubinterpreters(const QString& scriptPath, std::shared_ptr<ScriptBatch> batch) const;
+    void waitForScripts();
+    void waitForAsyncTransfers();
+    void startAdditionalKernels();
+    void stopAdditionalKernels();
+    std::string additionalConnectionFilePath(int kernel) const;
+    void warmUp();
+    void stopWarmUp();
 
 private:
     std::unique_ptr<XeusKernel>     _xeusKernel;
+    std::vector<std::unique_ptr<XeusKernel>> _additionalKernels = {};    /** Each in its own subinterpreter */
+    int                             _numAdditionalKernels = 0;
     std::string                     _connectionFilePath = {};
     std::string                     _kernelWorkingDirectory = {};
-    std::unordered_set<std::string> _baseModules = {};
+    bool                            _useIpcTransport = false;
+    std::unordered_set<std::string> _baseModules = {};          /** Guarded by the GIL, the warm-up adds its modules */
+    ModuleRetention                 _moduleRetention = ModuleRetention::OutsideScriptDirectory;
+    std::unordered_set<std::string> _retainedModules = {};      /** Top-level packages kept with ModuleRetention::Allowlist */
+    std::vector<std::string>        _warmUpModules = {};
+    std::thread                     _warmUpThread = {};
+    std::atomic<bool>               _stopWarmUp = false;
+    std::atomic<bool>               _kernelStarted = false;     /** Once notebook cells can run, scripts only unload the modules they added */
+    bool                            _scriptsInSubinterpreters = false;
+    std::unique_ptr<QThreadPool>    _scriptPool = {};           /** Runs scripts in subinterpreters */
+    std::unique_ptr<QThreadPool>    _mainScriptPool = {};       /** Runs scripts in the main interpreter, one at a time */
+    std::unique_ptr<QThreadPool>    _asyncPool = {};            /** Completes the mvstudio_core *_async functions */
+    mutable std::mutex              _scriptBatchesMutex;
+    mutable std::vector<std::weak_ptr<ScriptBatch>> _scriptBatches = {};  /** Cancelled by waitForScripts when runs are still queued */
     PyScopedInterpreterPtr          _mainPyInterpreter = {};
+    PyGilReleasePtr                 _releasedGil = {};          /** The GUI thread does not hold the GIL until the notebook is started */
 };
 
 
@@ -0,0 +1,188 @@
+#include "KernelTrace.h"
+
+#include <nlohmann/json.hpp>
+
+#include <algorithm>
+#include <chrono>
+#include <fstream>
+#include <string>
+
+namespace py = pybind11;
+
+namespace
+{
+    thread_local KernelTrace::Event* currentEvent = nullptr;
+
+    template<std::size_t N>
+    void copy_truncated(std::array<char, N>& target, std::string_view source)
+    {
+        const std::size_t length = std::min(source.size(), N - 1);
+        std::copy_n(source.data(), length, target.data());
+        target[length] = '\0';
+    }
+
+    std::string field_string(const auto& field)
+    {
+        return std::string(field.data());
+    }
+}
+
+void KernelTrace::Event::setMsgId(std::string_view id)
+{
+    copy_truncated(msgId, id);
+}
+
+void KernelTrace::Event::setMsgType(std::string_view type)
+{
+    copy_truncated(msgType, type);
+}
+
+KernelTrace::KernelTrace() :
+    _ring(capacity)
+{
+}
+
+KernelTrace& KernelTrace::instance()
+{
+    static KernelTrace trace;
+    return trace;
+}
+
+std::int64_t KernelTrace::now()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+}
+
+void KernelTrace::record(const Event& event)
+{
+    std::scoped_lock lock(_mutex);
+    _ring[_numRecorded % capacity] = event;
+    _numRecorded++;
+}
+
+std::vector<KernelTrace::Event> KernelTrace::events() const
+{
+    std::scoped_lock lock(_mutex);
+
+    const std::uint64_t numEvents = std::min<std::uint64_t>(_numRecorded, capacity);
+    const std::uint64_t first     = _numRecorded - numEvents;
+
+    std::vector<Event> result;
+    result.reserve(numEvents);
+    for (std::uint64_t i = first; i < _numRecorded; ++i)
+        result.push_back(_ring[i % capacity]);
+
+    return result;
+}
+
+void KernelTrace::recordPhase(std::string name, std::int64_t startNs, std::int64_t endNs)
+{
+    std::scoped_lock lock(_mutex);
+    _phases.push_back({ std::move(name), startNs, endNs });
+}
+
+std::vector<KernelTrace::Phase> KernelTrace::phases() const
+{
+    std::scoped_lock lock(_mutex);
+    return _phases;
+}
+
+std::string KernelTrace::chromeTrace() const
+{
+    nlohmann::json traceEvents = nlohmann::json::array();
+
+    // Chrome traces are in microseconds
+    auto us = [](std::int64_t ns) { return static_cast<double>(ns) / 1000.0; };
+
+    // startup phases are shown in a separate row
+    for (const Phase& phase : phases()) {
+        traceEvents.push_back({
+            { "name", phase.name }, { "cat", "startup" }, { "ph", "X" }, { "pid", 1 }, { "tid", 0 },
+            { "ts", us(phase.startNs) }, { "dur", us(phase.endNs - phase.startNs) },
+        });
+    }
+
+    for (const Event& event : events()) {
+        // waiting for the interpreter and handling are shown as consecutive slices
+        traceEvents.push_back({
+            { "name", "queued" }, { "cat", "kernel" }, { "ph", "X" }, { "pid", 1 }, { "tid", 1 },
+            { "ts", us(event.receivedNs) }, { "dur", us(event.startNs - event.receivedNs) },
+            { "args", { { "msg_id", field_string(event.msgId) } } },
+        });
+        traceEvents.push_back({
+            { "name", field_string(event.msgType) }, { "cat", "kernel" }, { "ph", "X" }, { "pid", 1 }, { "tid", 1 },
+            { "ts", us(event.startNs) }, { "dur", us(event.endNs - event.startNs) },
+            { "args", {
+                { "msg_id", field_string(event.msgId) },
+                { "code_hash", event.codeHash },
+                { "bytes_in", event.bytesIn },
+                { "bytes_out", event.bytesOut },
+            } },
+        });
+    }
+
+    return nlohmann::json({ { "traceEvents", traceEvents }, { "displayTimeUnit", "ms" } }).dump();
+}
+
+KernelTrace::Event* KernelTrace::current()
+{
+    return currentEvent;
+}
+
+void KernelTrace::setCurrent(Event* event)
+{
+    currentEvent = event;
+}
+
+namespace mvstudio_core {
+
+    void register_kernel_trace(pybind11::module_& m)
+    {
+        // Returns the recorded kernel messages, oldest first, as a list of dicts
+        // Timestamps are in ns of a monotonic clock
+        m.def("kernel_trace", []() {
+            py::list result;
+            for (const auto& event : KernelTrace::instance().events()) {
+                py::dict entry;
+                entry["msg_id"]     = field_string(event.msgId);
+                entry["msg_type"]   = field_string(event.msgType);
+                entry["received"]   = event.receivedNs;
+                entry["start"]      = event.startNs;
+                entry["end"]        = event.endNs;
+                entry["code_hash"]  = event.codeHash;
+                entry["bytes_in"]   = event.bytesIn;
+                entry["bytes_out"]  = event.bytesOut;
+                result.append(entry);
+            }
+            return result;
+        });
+
+        // Returns the startup phases as a list of dicts, durations are in ms
+        m.def("startup_timings", []() {
+            py::list result;
+            for (const auto& phase : KernelTrace::instance().phases()) {
+                py::dict entry;
+                entry["phase"]          = phase.name;
+                entry["start"]          = phase.startNs;
+                entry["duration_ms"]    = static_cast<double>(phase.endNs - phase.startNs) / 1'000'000.0;
+                result.append(entry);
+            }
+            return result;
+        });
+
+        // Returns the trace as Chrome trace event JSON, and writes it to path if given
+        m.def("kernel_trace_chrome", [](const std::string& path) {
+            const std::string trace = KernelTrace::instance().chromeTrace();
+
+            if (!path.empty()) {
+                std::ofstream file(path);
+                if (!file)
+                    throw py::value_error("kernel_trace_chrome: cannot write to " + path);
+                file << trace;
+            }
+
+            return trace;
+        }, py::arg("path") = std::string());
+    }
+
+} // namespace mvstudio_core
@@ -0,0 +1,108 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <array>
+#include <atomic>
+#include <cstdint>
+#include <mutex>
+#include <string>
+#include <string_view>
+#include <utility>
+#include <vector>
+
+/**
+ * Kernel trace
+ *
+ * Fixed-size ring buffer of the messages handled by the kernel.
+ * Recording an event copies a few fixed-size fields under an uncontended lock,
+ * nothing is allocated or formatted until the trace is read from python with
+ * mvstudio_core.kernel_trace() or mvstudio_core.kernel_trace_chrome().
+ *
+ * The XeusServer records one event per handled message. While a shell message is handled,
+ * the event is current on the interpreter thread such that the interpreter can add
+ * the code hash and size, output bytes are accumulated with addBytesOut.
+ *
+ * Startup phases, from creating the interpreter to starting the kernel and warming up modules,
+ * are recorded separately with ScopedPhase and read with mvstudio_core.startup_timings().
+ */
+class KernelTrace
+{
+public:
+    struct Event
+    {
+        std::array<char, 48>    msgId       = {};
+        std::array<char, 32>    msgType     = {};
+        std::int64_t            receivedNs  = 0;    /** Timestamps in ns of the steady clock, see now() */
+        std::int64_t            startNs     = 0;
+        std::int64_t            endNs       = 0;
+        std::uint64_t           codeHash    = 0;
+        std::uint64_t           bytesIn     = 0;
+        std::uint64_t           bytesOut    = 0;
+
+        void setMsgId(std::string_view id);
+        void setMsgType(std::string_view type);
+    };
+
+    struct Phase
+    {
+        std::string     name        = {};
+        std::int64_t    startNs     = 0;
+        std::int64_t    endNs       = 0;
+    };
+
+    /** Records the lifetime of the object as a startup phase */
+    class ScopedPhase
+    {
+    public:
+        explicit ScopedPhase(std::string name) : _name(std::move(name)), _startNs(now()) { }
+        ~ScopedPhase() { instance().recordPhase(std::move(_name), _startNs, now()); }
+
+        ScopedPhase(const ScopedPhase&) = delete;
+        ScopedPhase& operator=(const ScopedPhase&) = delete;
+
+    private:
+        std::string     _name;
+        std::int64_t    _startNs;
+    };
+
+    static constexpr std::size_t capacity = 4096;
+
+    static KernelTrace& instance();
+    static std::int64_t now();
+
+    void record(const Event& event);
+    void addBytesOut(std::uint64_t numBytes) { _bytesOut.fetch_add(numBytes, std::memory_order_relaxed); }
+    std::uint64_t takeBytesOut() { return _bytesOut.exchange(0, std::memory_order_relaxed); }
+
+    /** Recorded events, oldest first */
+    std::vector<Event> events() const;
+
+    void recordPhase(std::string name, std::int64_t startNs, std::int64_t endNs);
+
+    /** Recorded startup phases, in the order they finished */
+    std::vector<Phase> phases() const;
+
+    /** The events in the Chrome trace event format, to be loaded in chrome://tracing or Perfetto */
+    std::string chromeTrace() const;
+
+    /** Event of the message that is being handled on this thread, or nullptr */
+    static Event* current();
+    static void setCurrent(Event* event);
+
+private:
+    KernelTrace();
+
+private:
+    mutable std::mutex          _mutex;
+    std::vector<Event>          _ring;
+    std::uint64_t               _numRecorded = 0;
+    std::vector<Phase>          _phases = {};
+    std::atomic<std::uint64_t>  _bytesOut = 0;
+};
+
+namespace mvstudio_core {
+    void register_kernel_trace(pybind11::module_& m);
+}
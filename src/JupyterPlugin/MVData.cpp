@@ -1,6 +1,8 @@
 #include "MVData.h"
 
+#include "AsyncTransfer.h"
 #include "BindingUtils.h"
+#include "VariantConversion.h"
 
 #include <Application.h>
 #include <ClusterData/Cluster.h>
@@ -26,23 +28,163 @@
 #include <QSize>
 #include <QString>
 #include <QStringList>
+#include <QVariant>
 #include <QDebug>
 
 #include <algorithm>
 #include <array>
+#include <atomic>
 #include <cstdint>
+#include <cmath>
 #include <cstring>
+#include <format>
 #include <iterator>
+#include <limits>
 #include <map>
+#include <numeric>
+#include <optional>
 #include <string>
 #include <stdexcept>
 #include <type_traits>
+#include <utility>
 #include <vector>
 
 namespace py = pybind11;
 
 using namespace mv;
 
+// =============================================================================
+// Transfer budget 
+// =============================================================================
+
+namespace
+{
+    std::atomic<std::uint64_t> transferBudget = 0;
+
+    // Raises a python MemoryError if a transfer of numBytes exceeds the budget
+    void check_transfer_budget(std::uint64_t numBytes, const char* caller)
+    {
+        const std::uint64_t budget = transferBudget.load();
+
+        if (budget == 0 || numBytes <= budget)
+            return;
+
+        const std::string message = std::format("{}: transfer of {} bytes exceeds the transfer budget of {} bytes. "
+            "Request the data in chunks or raise the budget with mvstudio_core.set_transfer_budget", caller, numBytes, budget);
+        PyErr_SetString(PyExc_MemoryError, message.c_str());
+        throw py::error_already_set();
+    }
+
+    // Returns the item itself if it holds point data, otherwise its parent if that holds point data
+    DataHierarchyItem* get_points_item(DataHierarchyItem* item)
+    {
+        if (item && item->getDataType() != PointType)
+            item = item->getParent();
+
+        if (!item || item->getDataType() != PointType)
+            return nullptr;
+
+        return item;
+    }
+
+    // Number of rows and bytes per element of the numpy array a point dataset is transferred as
+    std::pair<size_t, size_t> points_transfer_size(mv::Dataset<Points>& points)
+    {
+        const size_t numRows = points->isFull() ? points->getNumPoints() : points->indices.size();
+
+        size_t elementSize = sizeof(float);
+        points->visitFromBeginToEnd([&elementSize](auto begin, auto end) {
+            elementSize = sizeof(numpy_element_t<std::remove_cvref_t<decltype(*begin)>>);
+        });
+
+        return { numRows, elementSize };
+    }
+
+    // Locks a dataset while another thread reads its data, such that it cannot be removed from the UI meanwhile
+    // Created on the GUI thread, the unlock is posted there so that the reading thread does not wait for the GUI thread
+    class DatasetReadLock
+    {
+    public:
+        explicit DatasetReadLock(DatasetImpl& dataset) :
+            _datasetId(dataset.getId()),
+            _locked(!dataset.isLocked())
+        {
+            if (_locked)
+                dataset.lock();
+        }
+
+        ~DatasetReadLock()
+        {
+            auto* app = QCoreApplication::instance();
+
+            if (!_locked || !app)
+                return;
+
+            QMetaObject::invokeMethod(app, [datasetId = _datasetId]() {
+                if (auto dataset = mv::data().getDataset(datasetId); dataset.isValid())
+                    dataset->unlock();
+            }, Qt::QueuedConnection);
+        }
+
+        DatasetReadLock(const DatasetReadLock&) = delete;
+        DatasetReadLock& operator=(const DatasetReadLock&) = delete;
+
+    private:
+        QString _datasetId;
+        bool    _locked = false;
+    };
+
+    // A point dataset resolved on the GUI thread, whose data the calling thread or a worker reads
+    struct PointsSource
+    {
+        Points*                             points = nullptr;
+        size_t                              numRows = 0;
+        size_t                              numDimensions = 0;
+        size_t                              elementSize = 0;    /** Of the numpy array */
+        std::unique_ptr<DatasetReadLock>    lock = {};
+
+        // Rows of a subset, empty if all rows are used
+        const std::vector<std::uint32_t>& rowIndices() const
+        {
+            static const std::vector<std::uint32_t> allRows = {};
+            return points->isFull() ? allRows : points->indices;
+        }
+    };
+
+    // Must be called on the GUI thread, the dataset stays locked while the source exists
+    PointsSource resolve_points_source(const std::string& datasetGuid, const char* caller)
+    {
+        const auto item = get_points_item(mv::dataHierarchy().getItem(QString(datasetGuid.c_str())));
+
+        if (!item)
+            throw py::value_error(std::string(caller) + ": dataset is not point data");
+
+        auto inputPoints                    = item->getDataset<Points>();
+        const auto [numRows, elementSize]   = points_transfer_size(inputPoints);
+
+        PointsSource source;
+        source.points           = inputPoints.get();
+        source.numRows          = numRows;
+        source.numDimensions    = inputPoints->getNumDimensions();
+        source.elementSize      = elementSize;
+        source.lock             = std::make_unique<DatasetReadLock>(*inputPoints);
+
+        return source;
+    }
+}
+
+namespace mvstudio_core {
+    void set_transfer_budget(std::uint64_t bytes)
+    {
+        transferBudget.store(bytes);
+    }
+
+    std::uint64_t get_transfer_budget()
+    {
+        return transferBudget.load();
+    }
+}
+
 // =============================================================================
 // ManiVault core and data interaction 
 // =============================================================================
@@ -57,29 +199,29 @@ py::object get_top_level_item_names()
 
 }
 
-// only works on top level items as test
 // Get the point data associated with the names item and return it as a numpy array to python
+// Only resolving and locking the dataset runs on the GUI thread, the data is copied on the calling thread
 py::array get_data_for_item(const std::string& datasetGuid)
 {
-    auto item = mv::dataHierarchy().getItem(QString(datasetGuid.c_str()));
+    const auto source = run_on_main_thread([&]() -> std::optional<PointsSource> {
+        // If this is not a point item we need the parent
+        if (!get_points_item(mv::dataHierarchy().getItem(QString(datasetGuid.c_str()))))
+            return std::nullopt;
 
-    // If this is not a point item we need the parent
-    auto dataType = item->getDataType();
-    if (dataType != PointType) {
-        item = item->getParent();
-        dataType = item->getDataType();
-        if (dataType != PointType) {
-            return py::array_t<float>(0);
-        }
-    }
+        return resolve_points_source(datasetGuid, "get_data_for_item");
+    });
+
+    if (!source)
+        return py::array_t<float>(0);
+
+    const auto numDimensions    = static_cast<unsigned int>(source->numDimensions);
+    const auto numPoints        = static_cast<unsigned int>(source->numRows);
 
-    auto inputPoints            = item->getDataset<Points>();
-    unsigned int numDimensions  = inputPoints->getNumDimensions();
-    unsigned int numPoints      = inputPoints->isFull() ? inputPoints->getNumPoints() : inputPoints->indices.size();
+    check_transfer_budget(static_cast<std::uint64_t>(numPoints) * numDimensions * source->elementSize, "get_data_for_item");
 
     // extract the source type 
     PointData::ElementTypeSpecifier dataSpec{};
-    inputPoints->visitSourceData([&dataSpec](auto pointData) {
+    source->points->visitSourceData([&dataSpec](auto pointData) {
         for (auto pointView : pointData) {
             for (auto value : pointView) {
                 dataSpec = getTypeSpecifier<decltype(value)>();
@@ -89,7 +231,6 @@ py::array get_data_for_item(const std::string& datasetGuid)
         }  
     });
 
-    qDebug() << "PointData::ElementTypeSpecifier is " << static_cast<int>(dataSpec);
     if (auto populate =
         (dataSpec == PointData::ElementTypeSpecifier::float32) ? populate_pyarray<float> :
         (dataSpec == PointData::ElementTypeSpecifier::uint16) ? populate_pyarray<std::uint16_t> :
@@ -97,12 +238,157 @@ py::array get_data_for_item(const std::string& datasetGuid)
         (dataSpec == PointData::ElementTypeSpecifier::uint8) ? populate_pyarray<std::uint8_t> :
         (dataSpec == PointData::ElementTypeSpecifier::int8) ? populate_pyarray<std::int8_t> :
         nullptr) {
-        return populate(inputPoints, numPoints, numDimensions);
+        return populate(*source->points, numPoints, numDimensions);
     }
 
     return py::array_t<float>(0);
 }
 
+// Get numRows rows of point data starting at startRow as a numpy array of shape (numRows, numDimensions)
+// Used to transfer datasets that exceed the transfer budget piece by piece
+py::array get_data_chunk_for_item(const std::string& datasetGuid, std::uint64_t startRow, std::uint64_t numRows)
+{
+    const PointsSource source   = run_on_main_thread([&]() { return resolve_points_source(datasetGuid, "get_data_chunk_for_item"); });
+    const size_t numDimensions  = source.numDimensions;
+
+    startRow = std::min<std::uint64_t>(startRow, source.numRows);
+    numRows  = std::min<std::uint64_t>(numRows, source.numRows - startRow);
+
+    check_transfer_budget(numRows * numDimensions * source.elementSize, "get_data_chunk_for_item");
+
+    // the data of an empty dataset, or past its end, cannot be visited
+    if (numRows == 0 || numDimensions == 0)
+        return py::array_t<float>(std::vector<size_t>{ static_cast<size_t>(numRows), numDimensions });
+
+    py::array result;
+    source.points->visitFromBeginToEnd([&](auto begin, auto end) {
+        using T = std::remove_cvref_t<decltype(*begin)>;
+        result = copy_rows_to_pyarray<numpy_element_t<T>>(&*begin, numDimensions, source.rowIndices(), startRow, numRows);
+    });
+
+    return result;
+}
+
+// Size of the numpy array that get_data_for_item (or get_image_item if asImage) would return for this dataset
+// Returns a dict with the entries: bytes, rawsize, budget, within_budget, shape and itemsize
+py::dict estimate_transfer(const std::string& datasetGuid, bool asImage)
+{
+    auto item = mv::dataHierarchy().getItem(QString(datasetGuid.c_str()));
+
+    if (!item)
+        throw py::value_error("estimate_transfer: no dataset with id " + datasetGuid);
+
+    std::uint64_t numBytes = 0;
+    size_t elementSize     = 0;
+    py::tuple shape;
+
+    if (asImage) {
+        if (item->getDataType() != ImageType)
+            throw py::value_error("estimate_transfer: dataset is not an image");
+
+        auto images                     = item->getDataset<Images>();
+        const std::uint64_t numImages   = images->getNumberOfImages();
+        const std::uint64_t numPixels   = images->getNumberOfPixels();
+        const std::uint64_t numComps    = images->getNumberOfComponentsPerPixel();
+
+        elementSize = sizeof(float);
+        numBytes    = numImages * numPixels * numComps * elementSize;
+        shape       = py::make_tuple(numImages, images->getImageSize().height(), images->getImageSize().width(), numComps);
+    }
+    else {
+        const auto pointsItem = get_points_item(item);
+
+        if (!pointsItem)
+            throw py::value_error("estimate_transfer: dataset is not point data");
+
+        auto points                 = pointsItem->getDataset<Points>();
+        const size_t numDimensions  = points->getNumDimensions();
+        const auto [numRows, size]  = points_transfer_size(points);
+
+        elementSize = size;
+        numBytes    = static_cast<std::uint64_t>(numRows) * numDimensions * elementSize;
+        shape       = py::make_tuple(numRows, numDimensions);
+        item        = pointsItem;
+    }
+
+    const std::uint64_t budget = mvstudio_core::get_transfer_budget();
+
+    py::dict result;
+    result["bytes"]         = numBytes;
+    result["rawsize"]       = static_cast<std::uint64_t>(item->getDataset()->getRawDataSize());
+    result["budget"]        = budget;
+    result["within_budget"] = budget == 0 || numBytes <= budget;
+    result["shape"]         = shape;
+    result["itemsize"]      = elementSize;
+
+    return result;
+}
+
+// Compute min, max, mean, standard deviation and optionally histograms per dimension
+// directly on the stored point data, without copying the data to python.
+// Non-finite values are ignored.
+py::dict compute_dimension_stats(const std::string& datasetGuid, const std::optional<std::vector<std::uint32_t>>& dims, std::uint32_t bins)
+{
+    // Only resolving the dataset needs the GUI thread, the statistics are computed on the calling thread
+    const PointsSource source   = run_on_main_thread([&]() { return resolve_points_source(datasetGuid, "compute_dimension_stats"); });
+    const size_t numDimensions  = source.numDimensions;
+    const size_t numRows        = source.numRows;
+
+    std::vector<std::uint32_t> selectedDims(numDimensions);
+    std::iota(selectedDims.begin(), selectedDims.end(), 0);
+
+    if (dims.has_value()) {
+        selectedDims = dims.value();
+
+        if (std::any_of(selectedDims.begin(), selectedDims.end(), [numDimensions](std::uint32_t dim) { return dim >= numDimensions; }))
+            throw py::index_error("compute_dimension_stats: dimension index out of range");
+    }
+
+    DimensionStats stats(selectedDims.size());
+
+    const size_t numSelected = selectedDims.size();
+    std::vector<std::uint64_t> histograms(numSelected * bins, 0);
+
+    // an empty dataset has no data to visit
+    if (numRows > 0 && numSelected > 0) {
+        py::gil_scoped_release release;
+
+        source.points->visitFromBeginToEnd([&](auto begin, auto end) {
+            const auto* data = &*begin;
+            stats = compute_dimension_stats_impl(data, numDimensions, source.rowIndices(), numRows, selectedDims);
+
+            if (bins > 0)
+                histograms = compute_dimension_histograms_impl(data, numDimensions, source.rowIndices(), numRows, selectedDims, stats, bins);
+        });
+    }
+
+    // Dimensions without finite values have NaN statistics and bin edges, and empty histograms
+    const std::vector<double> stddev = stats.stddev();
+    stats.setEmptyToNaN();
+
+    py::dict result;
+    result["dims"]  = py::array_t<std::uint32_t>(numSelected, selectedDims.data());
+    result["count"] = py::array_t<std::uint64_t>(numSelected, stats.count.data());
+    result["min"]   = py::array_t<double>(numSelected, stats.min.data());
+    result["max"]   = py::array_t<double>(numSelected, stats.max.data());
+    result["mean"]  = py::array_t<double>(numSelected, stats.mean.data());
+    result["std"]   = py::array_t<double>(numSelected, stddev.data());
+
+    if (bins > 0) {
+        const std::vector<double> edges = dimension_bin_edges(stats, bins);
+        auto binEdges = py::array_t<double>({ numSelected, static_cast<size_t>(bins) + 1 });
+        std::copy(edges.begin(), edges.end(), binEdges.mutable_data());
+
+        auto histogram = py::array_t<std::uint64_t>({ numSelected, static_cast<size_t>(bins) });
+        std::copy(histograms.begin(), histograms.end(), static_cast<std::uint64_t*>(histogram.request().ptr));
+
+        result["histogram"] = histogram;
+        result["bin_edges"] = binEdges;
+    }
+
+    return result;
+}
+
 // Get the selected data points for a data set
 py::array get_selection_for_item(const std::string& datasetGuid)
 {
@@ -136,6 +422,37 @@ void set_selection_for_item(const std::string& datasetGuid, const std::vector<ui
     mv::events().notifyDatasetDataSelectionChanged(data);
 }
 
+namespace
+{
+    // Creates the points of add_new_point_data, in the root of the hierarchy or below dataSetParentID
+    auto new_points_generator(const std::string& dataSetName, const std::string& dataSetParentID)
+    {
+        return [dataSetName, dataSetParentID]() -> mv::Dataset<Points> {
+            const Dataset<DatasetImpl> parentData = 
+                /* if */   dataSetParentID.empty() ?
+                /* then */ Dataset<DatasetImpl>() :
+                /* else */ mv::data().getDataset(QString::fromStdString(dataSetParentID));
+
+            return mv::data().createDataset<Points>("Points", dataSetName.c_str(), parentData);
+            };
+    }
+
+    // Creates the points of add_derived_point_data, an invalid dataset if the source data is not valid
+    auto derived_points_generator(const std::string& dataSetName, const std::string& dataSetSourceID)
+    {
+        return [dataSetName, dataSetSourceID]() -> mv::Dataset<Points> {
+            const Dataset<DatasetImpl> sourceData = mv::data().getDataset(QString::fromStdString(dataSetSourceID));
+
+            if (!sourceData.isValid()) {
+                qDebug() << "add_new_derived_point_data: source data is not valid";
+                return {};
+            }
+
+            return mv::Dataset<Points>(mv::data().createDerivedDataset(dataSetName.c_str(), sourceData, sourceData));
+            };
+    }
+}
+
 /**
  * Add new point data in the root of the hierarchy or below dataSetParentID.
  * If successful returns a guid for the new point data
@@ -143,17 +460,7 @@ void set_selection_for_item(const std::string& datasetGuid, const std::vector<ui
  */
 std::string add_new_point_data(const py::array& data, const std::string& dataSetName, const std::string& dataSetParentID, const std::vector<std::string>& dimensionNames)
 {
-    auto generateNewPoints = [dataSetName, dataSetParentID]() -> mv::Dataset<Points> {
-        const Dataset<DatasetImpl> parentData = 
-            /* if */   dataSetParentID.empty() ?
-            /* then */ Dataset<DatasetImpl>() :
-            /* else */ mv::data().getDataset(QString::fromStdString(dataSetParentID));
-
-        return mv::data().createDataset<Points>("Points", dataSetName.c_str(), parentData);
-        };
-
-
-    return add_point_data(data, dimensionNames, generateNewPoints);
+    return add_point_data(data, dimensionNames, new_points_generator(dataSetName, dataSetParentID));
 }
 
 /**
@@ -168,12 +475,7 @@ std::string add_derived_point_data(const py::array& data, const std::string& dat
         return "";
     }
 
-    auto generateDerivedPoints = [dataSetName, dataSetSourceID]() -> mv::Dataset<Points> {
-        const Dataset<DatasetImpl> sourceData = mv::data().getDataset(QString::fromStdString(dataSetSourceID));
-        return mv::Dataset<Points>(mv::data().createDerivedDataset(dataSetName.c_str(), sourceData, sourceData));
-        };
-
-    return add_point_data(data, dimensionNames, generateDerivedPoints);
+    return add_point_data(data, dimensionNames, derived_points_generator(dataSetName, dataSetSourceID));
 }
 
 // The MV data model is Band Interlaced by Pixel.
@@ -277,61 +579,96 @@ std::string add_new_image_data(const py::array& data, const std::string& dataSet
     return guid;
 }
 
-// All images are float in ManiVault 1.x.
-// An Image parent may be a Points or Cluster item
-py::array get_mv_image(const std::string& imageGuid)
+namespace
 {
-    auto item               = mv::dataHierarchy().getItem(QString(imageGuid.c_str()));
-    auto images             = item->getDataset<Images>();
-    uint32_t numImages      = images->getNumberOfImages();
-    uint32_t numPixels      = images->getNumberOfPixels();
-    uint32_t numComponents  = images->getNumberOfComponentsPerPixel();
-    QSize imqSize           = images->getImageSize();
-    unsigned int width      = static_cast<unsigned int>(imqSize.width());
-    unsigned int height     = static_cast<unsigned int>(imqSize.height());
-    size_t pixcmpSize       = static_cast<size_t>(numPixels) * numComponents;
-
-    // For further information on why the numpy array shapes are 
-    // specified as shown see 
-    // https://scikit-image.org/skimage-tutorials/lectures/00_images_are_arrays.html#other-shapes-and-their-meanings
-
-    std::vector<unsigned int> shape{0};
-
-    if (numImages == 1) {
-        if (numComponents == 1) {
-            // 2D Grayscale
-            shape = std::vector<unsigned int>({ height, width });
-        }
-        else {
-            // 2D Multichannel
-            shape = std::vector<unsigned int> { height, width, numComponents };
-        }
-    } else {
+    // An image dataset resolved on the GUI thread, its scalar data is copied by copy_images
+    struct ImagesSource
+    {
+        Images*                             images = nullptr;
+        uint32_t                            numImages = 0;
+        size_t                              pixcmpSize = 0;     /** Number of values per image */
+        std::vector<unsigned int>           shape = {};         /** Shape of the numpy array */
+        std::unique_ptr<DatasetReadLock>    lock = {};
+    };
+
+    // Must be called on the GUI thread, the dataset stays locked while the source exists
+    ImagesSource resolve_images_source(const std::string& imageGuid)
+    {
+        auto item = mv::dataHierarchy().getItem(QString(imageGuid.c_str()));
 
-        if (numComponents == 1) {
-            // 3D Grayscale
-            shape = std::vector<unsigned int> { numImages, height, width };
-        }
-        else {
-            // 3D Multichannel
-            shape = std::vector<unsigned int> { numImages, height, width, numComponents };
+        if (!item || item->getDataType() != ImageType)
+            throw py::value_error("get_image_item: dataset is not an image");
+
+        auto images             = item->getDataset<Images>();
+        uint32_t numImages      = images->getNumberOfImages();
+        uint32_t numPixels      = images->getNumberOfPixels();
+        uint32_t numComponents  = images->getNumberOfComponentsPerPixel();
+        QSize imqSize           = images->getImageSize();
+        unsigned int width      = static_cast<unsigned int>(imqSize.width());
+        unsigned int height     = static_cast<unsigned int>(imqSize.height());
+        size_t pixcmpSize       = static_cast<size_t>(numPixels) * numComponents;
+
+        check_transfer_budget(static_cast<std::uint64_t>(numImages) * pixcmpSize * sizeof(float), "get_image_item");
+
+        // For further information on why the numpy array shapes are 
+        // specified as shown see 
+        // https://scikit-image.org/skimage-tutorials/lectures/00_images_are_arrays.html#other-shapes-and-their-meanings
+
+        std::vector<unsigned int> shape{0};
+
+        if (numImages == 1) {
+            if (numComponents == 1) {
+                // 2D Grayscale
+                shape = std::vector<unsigned int>({ height, width });
+            }
+            else {
+                // 2D Multichannel
+                shape = std::vector<unsigned int> { height, width, numComponents };
+            }
+        } else {
+
+            if (numComponents == 1) {
+                // 3D Grayscale
+                shape = std::vector<unsigned int> { numImages, height, width };
+            }
+            else {
+                // 3D Multichannel
+                shape = std::vector<unsigned int> { numImages, height, width, numComponents };
+            }
         }
+
+        return { images.get(), numImages, pixcmpSize, std::move(shape), std::make_unique<DatasetReadLock>(*images) };
     }
 
-    auto result                 = py::array_t<float>(shape);
-    py::buffer_info result_info = result.request();
-    float* output               = static_cast<float*>(result_info.ptr);
+    // Copies the scalar data of all images, this does not need the GUI thread
+    py::array copy_images(const ImagesSource& source)
+    {
+        auto result                 = py::array_t<float>(source.shape);
+        py::buffer_info result_info = result.request();
+        float* output               = static_cast<float*>(result_info.ptr);
+
+        {
+            py::gil_scoped_release release;
+
+            QVector<float> scalarData(static_cast<qsizetype>(source.pixcmpSize));
+            QPair<float, float> scalarDataRange;
 
-    for (uint32_t imIdx = 0; imIdx < numImages; ++imIdx) {
-        QVector<float> scalarData(static_cast<size_t>(numPixels) * numComponents);
-        QPair<float, float> scalarDataRange;
-        images->getImageScalarData(imIdx, scalarData, scalarDataRange);
+            for (uint32_t imIdx = 0; imIdx < source.numImages; ++imIdx) {
+                source.images->getImageScalarData(imIdx, scalarData, scalarDataRange);
+                std::copy_n(scalarData.cbegin(), source.pixcmpSize, output + imIdx * source.pixcmpSize);
+            }
+        }
 
-        for (size_t pixcmpIdx = 0; pixcmpIdx < pixcmpSize; ++pixcmpIdx)
-            output[(imIdx * pixcmpSize) + pixcmpIdx] = scalarData[pixcmpIdx];
+        return result;
     }
+}
 
-    return result;
+// All images are float in ManiVault 1.x.
+// An Image parent may be a Points or Cluster item
+// The dataset is resolved on the GUI thread, its data is copied on the calling thread
+py::array get_mv_image(const std::string& imageGuid)
+{
+    return copy_images(run_on_main_thread([&]() { return resolve_images_source(imageGuid); }));
 }
 
 std::string add_new_cluster_data(const std::string& parentPointDatasetGuid, const std::vector<py::array>& clusterIndices, const std::vector<std::string>& clusterNames, const std::vector<py::array>& clusterColors, const std::string& datasetName)
@@ -400,6 +737,19 @@ py::list get_top_level_guids()
     return results;
 }
 
+// Look up a data hierarchy item by its own guid or by the guid of its dataset
+// Returns a (Data Hierarchy Item guid, Dataset guid) tuple or None
+py::object resolve(const std::string& guid)
+{
+    const QString id = QString::fromStdString(guid);
+
+    DataHierarchyItem* item = findHierarchyItem(id);
+    if (!item)
+        return py::none();
+
+    return py::make_tuple(item->getId().toStdString(), item->getDataset()->getId().toStdString());
+}
+
 std::uint64_t get_item_numdimensions(const std::string& datasetGuid)
 {
     auto item = mv::dataHierarchy().getItem(QString(datasetGuid.c_str()));
@@ -445,7 +795,7 @@ std::vector<std::string> get_item_properties(const std::string& datasetGuid)
     auto dataset = item->getDataset<Points>();
     QStringList propertyNamesQt = dataset->propertyNames();
     std::vector<std::string> propertyNames;
-    propertyNames.resize(propertyNamesQt.size());
+    propertyNames.reserve(propertyNamesQt.size());
 
     for (const auto& propertyName : propertyNamesQt) {
         propertyNames.push_back(propertyName.toStdString());
@@ -468,46 +818,22 @@ py::object get_item_property(const std::string& datasetGuid, const std::string&
         return py::none();
     }
 
-    auto variant_to_pyobject = [](const QVariant& var) -> py::object {
-        switch (var.typeId()) {
-        case QMetaType::Int:
-            return py::int_(var.toInt());
-        case QMetaType::UInt:
-            return py::int_(var.toUInt());
-        case QMetaType::LongLong:
-            return py::int_(var.toLongLong());
-        case QMetaType::ULongLong:
-            return py::int_(var.toULongLong());
-        case QMetaType::Float:
-            return py::float_(var.toFloat());
-        case QMetaType::Double:
-            return py::float_(var.toDouble());
-        case QMetaType::Bool:
-            return py::bool_(var.toBool());
-        case QMetaType::Char:
-            return py::str(var.toChar().decomposition().toStdString());
-        case QMetaType::QString:
-            return py::str(var.toString().toStdString());
-        default:
-            return py::none();
-        }
-        };
+    return property_to_pyobject(property);
+}
 
-    py::object res;
-    py::list pyList;
+// Get all properties of a dataset in one call
+// Returns a dict of property name to value
+py::dict get_item_properties_dict(const std::string& datasetGuid)
+{
+    auto item = mv::dataHierarchy().getItem(QString(datasetGuid.c_str()));
+    auto dataset = item->getDataset<Points>();
 
-    if (property.typeId() == QMetaType::QVariantList) {
-        const QVariantList list = property.toList();
-        for (const QVariant& item : list) {
-            pyList.append(variant_to_pyobject(item));
-        }
-        res = pyList;
-    }
-    else {
-        res = variant_to_pyobject(property);
+    py::dict properties;
+    for (const auto& propertyName : dataset->propertyNames()) {
+        properties[py::str(propertyName.toStdString())] = property_to_pyobject(dataset->getProperty(propertyName));
     }
 
-    return res;
+    return properties;
 }
 
 // Get all children
@@ -602,23 +928,30 @@ py::tuple get_cluster(const std::string& datasetGuid)
     py::list ids;
     py::list colors;
     py::list indexes_list;
+    std::vector<unsigned int*> outputs;
+    outputs.reserve(clusters.size());
     for (const auto& cluster: clusters) {
         ids.append(cluster.getId().toStdString());
         auto color = cluster.getColor();
         float r, g, b, a;
         color.getRgbF(&r, &g, &b, &a);
         colors.append(py::make_tuple(r, g, b, a));
-        const auto& indices = cluster.getIndices();
-        size_t size = indices.size();
-
-        auto indexArray = py::array_t<unsigned int>(size);
-        py::buffer_info array_info = indexArray.request();
-        unsigned int* output = static_cast<unsigned int*>(array_info.ptr);
-        for (size_t i = 0; i < size; i++) {
-            output[i] = indices[i];
-        }
+
+        auto indexArray = py::array_t<unsigned int>(cluster.getIndices().size());
+        outputs.push_back(static_cast<unsigned int*>(indexArray.request().ptr));
         indexes_list.append(indexArray);
     }
+
+    // the arrays are allocated, copy the indices without holding the GIL
+    {
+        py::gil_scoped_release release;
+
+        for (size_t c = 0; c < outputs.size(); ++c) {
+            const auto& indices = clusters[c].getIndices();
+            std::copy(indices.cbegin(), indices.cend(), outputs[c]);
+        }
+    }
+
     return py::make_tuple(indexes_list, names, colors, ids);
 }
 
@@ -678,6 +1011,64 @@ bool set_linked_data(const std::string& sourceDataGuid, const std::string& targe
     return true;
 }
 
+// =============================================================================
+// Asynchronous transfers 
+// =============================================================================
+
+// The dataset is resolved on the GUI thread, its data is copied on the worker
+py::object get_data_for_item_async(const std::string& datasetGuid)
+{
+    return submit_async([datasetGuid]() -> py::object {
+        const PointsSource source = run_on_main_thread([&]() { return resolve_points_source(datasetGuid, "get_data_for_item"); });
+
+        check_transfer_budget(static_cast<std::uint64_t>(source.numRows) * source.numDimensions * source.elementSize, "get_data_for_item");
+
+        // the data of an empty dataset cannot be visited
+        if (source.numRows == 0 || source.numDimensions == 0)
+            return py::array_t<float>(std::vector<size_t>{ source.numRows, source.numDimensions });
+
+        py::array result;
+        source.points->visitFromBeginToEnd([&](auto begin, auto end) {
+            using T = std::remove_cvref_t<decltype(*begin)>;
+            result = copy_rows_to_pyarray<numpy_element_t<T>>(&*begin, source.numDimensions, source.rowIndices(), 0, source.numRows);
+        });
+
+        return result;
+    });
+}
+
+py::object get_mv_image_async(const std::string& imageGuid)
+{
+    return submit_async([imageGuid]() -> py::object {
+        return copy_images(run_on_main_thread([&]() { return resolve_images_source(imageGuid); }));
+    });
+}
+
+// The numpy data is converted on the worker, only creating the dataset runs on the GUI thread
+py::object add_new_point_data_async(const py::array& data, const std::string& dataSetName, const std::string& dataSetParentID, const std::vector<std::string>& dimensionNames)
+{
+    return submit_async([data, dataSetName, dataSetParentID, dimensionNames]() -> py::object {
+        auto pointValues = point_values_from_numpy(data);
+
+        if (!pointValues)
+            return py::str("");
+
+        return py::str(run_on_main_thread([&]() { return add_point_values(std::move(*pointValues), dimensionNames, new_points_generator(dataSetName, dataSetParentID)); }));
+    });
+}
+
+py::object add_derived_point_data_async(const py::array& data, const std::string& dataSetName, const std::string& dataSetSourceID, const std::vector<std::string>& dimensionNames)
+{
+    return submit_async([data, dataSetName, dataSetSourceID, dimensionNames]() -> py::object {
+        auto pointValues = point_values_from_numpy(data);
+
+        if (!pointValues)
+            return py::str("");
+
+        return py::str(run_on_main_thread([&]() { return add_point_values(std::move(*pointValues), dimensionNames, derived_points_generator(dataSetName, dataSetSourceID)); }));
+    });
+}
+
 // =============================================================================
 // ManiVault embedding module 
 // =============================================================================
@@ -685,54 +1076,88 @@ bool set_linked_data(const std::string& sourceDataGuid, const std::string& targe
 namespace mvstudio_core {
     void register_mv_core_module(pybind11::module_& m)
     {
-        m.def("get_top_level_item_names", get_top_level_item_names);
-        m.def("get_top_level_guids", get_top_level_guids);
+        m.def("get_top_level_item_names", on_main_thread(get_top_level_item_names));
+        m.def("get_top_level_guids", on_main_thread(get_top_level_guids));
+        m.def("resolve", on_main_thread(resolve), py::arg("guid") = std::string());
         m.def("get_data_for_item", get_data_for_item, py::arg("datasetGuid") = std::string());
-        m.def("get_selection_for_item", get_selection_for_item, py::arg("datasetGuid") = std::string());
-        m.def("set_selection_for_item", set_selection_for_item, py::arg("datasetGuid") = std::string(), py::arg("selectionIDs") = std::vector<uint32_t>());
+        m.def("get_data_chunk_for_item", get_data_chunk_for_item, py::arg("datasetGuid") = std::string(), py::arg("startRow") = 0, py::arg("numRows") = 0);
+        m.def("estimate_transfer", on_main_thread(estimate_transfer), py::arg("datasetGuid") = std::string(), py::arg("asImage") = false);
+        m.def("set_transfer_budget", set_transfer_budget, py::arg("bytes") = 0);
+        m.def("get_transfer_budget", get_transfer_budget);
+        // Runs fn on the GUI thread, such that the mvstudio_core calls in fn are marshalled as one batch
+        m.def("run_on_main", [](const py::function& fn) {
+            return run_on_main_thread([&]() -> py::object { return fn(); });
+        }, py::arg("fn"));
+        m.def("compute_dimension_stats", 
+            compute_dimension_stats, 
+            py::arg("datasetGuid") = std::string(), 
+            py::arg("dims") = std::optional<std::vector<std::uint32_t>>(), 
+            py::arg("bins") = 0
+        );
+        m.def("get_selection_for_item", on_main_thread(get_selection_for_item), py::arg("datasetGuid") = std::string());
+        m.def("set_selection_for_item", on_main_thread(set_selection_for_item), py::arg("datasetGuid") = std::string(), py::arg("selectionIDs") = std::vector<uint32_t>());
         m.def("get_image_item", get_mv_image, py::arg("datasetGuid") = std::string());
-        m.def("get_item_name", get_item_name, py::arg("datasetGuid") = std::string());
-        m.def("get_item_rawsize", get_item_rawsize, py::arg("datasetGuid") = std::string());
-        m.def("get_item_type", get_item_type, py::arg("datasetGuid") = std::string());
-        m.def("get_item_rawname", get_item_rawname, py::arg("datasetGuid") = std::string());
-        m.def("get_item_numdimensions", get_item_numdimensions, py::arg("datasetGuid") = std::string());
-        m.def("get_item_numpoints", get_item_numpoints, py::arg("datasetGuid") = std::string());
-        m.def("get_item_children", get_item_children, py::arg("datasetGuid") = std::string());
-        m.def("get_item_properties", get_item_properties, py::arg("datasetGuid") = std::string());
-        m.def("get_item_property", get_item_property, py::arg("datasetGuid") = std::string(), py::arg("propertyName") = std::string());
-        m.def("get_data_type", get_data_type, py::arg("datasetGuid") = std::string());
-        m.def("find_image_dataset", find_image_dataset, py::arg("datasetGuid") = std::string());
-        m.def("get_image_dimensions", get_image_dimensions, py::arg("datasetGuid") = std::string());
-        m.def("get_cluster", get_cluster, py::arg("datasetGuid") = std::string());
+        m.def("get_item_name", on_main_thread(get_item_name), py::arg("datasetGuid") = std::string());
+        m.def("get_item_rawsize", on_main_thread(get_item_rawsize), py::arg("datasetGuid") = std::string());
+        m.def("get_item_type", on_main_thread(get_item_type), py::arg("datasetGuid") = std::string());
+        m.def("get_item_rawname", on_main_thread(get_item_rawname), py::arg("datasetGuid") = std::string());
+        m.def("get_item_numdimensions", on_main_thread(get_item_numdimensions), py::arg("datasetGuid") = std::string());
+        m.def("get_item_numpoints", on_main_thread(get_item_numpoints), py::arg("datasetGuid") = std::string());
+        m.def("get_item_children", on_main_thread(get_item_children), py::arg("datasetGuid") = std::string());
+        m.def("get_item_properties", on_main_thread(get_item_properties), py::arg("datasetGuid") = std::string());
+        m.def("get_item_property", on_main_thread(get_item_property), py::arg("datasetGuid") = std::string(), py::arg("propertyName") = std::string());
+        m.def("get_item_properties_dict", on_main_thread(get_item_properties_dict), py::arg("datasetGuid") = std::string());
+        m.def("get_data_type", on_main_thread(get_data_type), py::arg("datasetGuid") = std::string());
+        m.def("find_image_dataset", on_main_thread(find_image_dataset), py::arg("datasetGuid") = std::string());
+        m.def("get_image_dimensions", on_main_thread(get_image_dimensions), py::arg("datasetGuid") = std::string());
+        m.def("get_cluster", on_main_thread(get_cluster), py::arg("datasetGuid") = std::string());
         m.def("set_linked_data",
-            set_linked_data,
+            on_main_thread(set_linked_data),
             py::arg("sourceDataGuid") = std::string(),
             py::arg("targetDataGuid") = std::string(),
             py::arg("selectionFromAToB") = std::vector<std::vector<int64_t>>()
             );
         m.def("add_new_points",
-            add_new_point_data,
+            on_main_thread(add_new_point_data),
             py::arg("data"),    // do NOT = py::array() as this breaks loading the module in subinterpreters
             py::arg("dataSetName") = std::string(),
             py::arg("dataSetParentID") = std::string(),
             py::arg("dimensionNames") = std::vector<std::string>()
         );
         m.def( "add_derived_points",
-            add_derived_point_data,
+            on_main_thread(add_derived_point_data),
+            py::arg("data"),    // do NOT = py::array() as this breaks loading the module in subinterpreters
+            py::arg("dataSetName") = std::string(),
+            py::arg("dataSetSourceID") = std::string(),
+            py::arg("dimensionNames") = std::vector<std::string>()
+        );
+        m.attr("AsyncFuture") = create_async_future_type();
+        // The *_async variants return an awaitable when called from a running asyncio loop and a concurrent.futures.Future otherwise
+        m.def("get_data_for_item_async", get_data_for_item_async, py::arg("datasetGuid") = std::string());
+        m.def("get_image_item_async", get_mv_image_async, py::arg("datasetGuid") = std::string());
+        m.def("add_new_points_async",
+            add_new_point_data_async,
+            py::arg("data"),    // do NOT = py::array() as this breaks loading the module in subinterpreters
+            py::arg("dataSetName") = std::string(),
+            py::arg("dataSetParentID") = std::string(),
+            py::arg("dimensionNames") = std::vector<std::string>()
+        );
+        m.def("add_derived_points_async",
+            add_derived_point_data_async,
             py::arg("data"),    // do NOT = py::array() as this breaks loading the module in subinterpreters
             py::arg("dataSetName") = std::string(),
             py::arg("dataSetSourceID") = std::string(),
             py::arg("dimensionNames") = std::vector<std::string>()
         );
         m.def("add_new_image",
-            add_new_image_data,
+            on_main_thread(add_new_image_data),
             py::arg("data"),    // do NOT = py::array() as this breaks loading the module in subinterpreters
             py::arg("dataSetName") = std::string(),
             py::arg("dimensionNames") = std::vector<std::string>()
         );
         // The cluster tuple contains the following lists: names, indexes (clusters), colors, ids (ignored)
         m.def("add_new_clusters",
-            add_new_cluster_data,
+            on_main_thread(add_new_cluster_data),
             py::arg("parentPointDatasetGuid") = std::string(),
             py::arg("clusterIndices") = std::vector<py::array>(),
             py::arg("clusterNames") = std::vector<std::string>(),
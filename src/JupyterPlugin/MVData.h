@@ -1,6 +1,7 @@
 #pragma once
 
 #include <cstdint>
+#include <optional>
 #include <string>
 #include <vector>
 
@@ -28,6 +29,10 @@ namespace mvstudio_core {
     }
 
     void register_mv_core_module(pybind11::module_& m);
+
+    // Largest number of bytes a single data transfer to python may allocate, 0 is unlimited
+    void set_transfer_budget(std::uint64_t bytes);
+    std::uint64_t get_transfer_budget();
 }
 
 // =============================================================================
@@ -36,17 +41,22 @@ namespace mvstudio_core {
 
 pybind11::object get_top_level_item_names();
 pybind11::array get_data_for_item(const std::string& datasetGuid);
+pybind11::array get_data_chunk_for_item(const std::string& datasetGuid, std::uint64_t startRow, std::uint64_t numRows);
+pybind11::dict estimate_transfer(const std::string& datasetGuid, bool asImage);
 pybind11::list get_top_level_guids();
+pybind11::object resolve(const std::string& guid);
 std::uint64_t get_item_numdimensions(const std::string& datasetGuid);
 std::uint64_t get_item_numpoints(const std::string& datasetGuid);
 std::string get_item_name(const std::string& datasetGuid);
 std::string get_item_type(const std::string& datasetGuid);
 std::string get_item_rawname(const std::string& datasetGuid);
+pybind11::dict compute_dimension_stats(const std::string& datasetGuid, const std::optional<std::vector<std::uint32_t>>& dims, std::uint32_t bins);
 pybind11::array get_selection_for_item(const std::string& datasetGuid);
 void set_selection_for_item(const std::string& datasetGuid, const std::vector<uint32_t>& selectionIDs);
 std::uint64_t get_item_rawsize(const std::string& datasetGuid);
 std::vector<std::string> get_item_properties(const std::string& datasetGuid);
 pybind11::object get_item_property(const std::string& datasetGuid, const std::string& propertyName);
+pybind11::dict get_item_properties_dict(const std::string& datasetGuid);
 pybind11::list get_item_children(const std::string& datasetGuid);
 mvstudio_core::DataItemType get_data_type(const std::string& datasetGuid);
 std::string find_image_dataset(const std::string& datasetGuid);
@@ -59,4 +69,9 @@ std::string add_new_image_data(const pybind11::array& data, const std::string& d
 pybind11::array get_mv_image(const std::string& imageGuid);
 std::string add_new_cluster_data(const std::string& parentPointDatasetGuid, const std::vector<pybind11::array>& clusterIndices, const std::vector<std::string>& clusterNames, const std::vector<pybind11::array>& clusterColors, const std::string& datasetName);
 
+pybind11::object get_data_for_item_async(const std::string& datasetGuid);
+pybind11::object get_mv_image_async(const std::string& imageGuid);
+pybind11::object add_new_point_data_async(const pybind11::array& data, const std::string& dataSetName, const std::string& dataSetParentID, const std::vector<std::string>& dimensionNames);
+pybind11::object add_derived_point_data_async(const pybind11::array& data, const std::string& dataSetName, const std::string& dataSetSourceID, const std::vector<std::string>& dimensionNames);
+
 bool set_linked_data(const std::string& sourceDataGuid, const std::string& targetDataGuid, const std::vector<std::vector<int64_t>>& selectionFromAToB);
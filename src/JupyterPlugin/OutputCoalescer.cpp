@@ -0,0 +1,190 @@
+#include "OutputCoalescer.h"
+
+#include "KernelTrace.h"
+
+#undef slots
+#include <pybind11/stl.h>
+#define slots Q_SLOTS
+
+#include <QDebug>
+
+#include <exception>
+#include <format>
+#include <optional>
+#include <stdexcept>
+#include <utility>
+
+namespace py = pybind11;
+
+OutputCoalescer::OutputCoalescer(Publisher publisher) :
+    _publisher(std::move(publisher)),
+    _flusher([this](std::stop_token stopToken) { runFlusher(stopToken); })
+{
+}
+
+OutputCoalescer::~OutputCoalescer()
+{
+    _flusher.request_stop();
+    _flusher.join();
+}
+
+std::size_t OutputCoalescer::utf8Prefix(const std::string& text, std::size_t maxBytes)
+{
+    if (maxBytes >= text.size())
+        return text.size();
+
+    // back off over continuation bytes (10xxxxxx) to the lead byte of the split sequence
+    while (maxBytes > 0 && (static_cast<unsigned char>(text[maxBytes]) & 0xC0) == 0x80)
+        --maxBytes;
+
+    return maxBytes;
+}
+
+void OutputCoalescer::write(const std::string& name, const std::string& text)
+{
+    if (text.empty())
+        return;
+
+    std::unique_lock lock(_mutex);
+
+    const std::uint64_t maxCellBytes = settings().maxCellBytes;
+    std::uint64_t numBytes           = text.size();
+
+    if (maxCellBytes > 0 && _cellBytes + numBytes > maxCellBytes) {
+        // the stream messages are json, which cannot hold a partial UTF-8 sequence
+        const std::uint64_t remaining = utf8Prefix(text, maxCellBytes > _cellBytes ? maxCellBytes - _cellBytes : 0);
+        _droppedBytes += numBytes - remaining;
+        numBytes = remaining;
+    }
+
+    if (numBytes == 0 || !_publisher)
+        return;
+
+    // keep the order of stdout and stderr output
+    if (!_buffer.empty() && name != _name)
+        flushLocked();
+
+    if (_buffer.empty()) {
+        _name               = name;
+        _firstBufferedWrite = Clock::now();
+        _wakeFlusher.notify_one();
+    }
+
+    _buffer.append(text, 0, numBytes);
+    _cellBytes += numBytes;
+    KernelTrace::instance().addBytesOut(numBytes);
+
+    if (_buffer.size() >= settings().flushBytes)
+        flushLocked();
+}
+
+void OutputCoalescer::flush()
+{
+    std::unique_lock lock(_mutex);
+    flushLocked();
+}
+
+void OutputCoalescer::endCell()
+{
+    std::unique_lock lock(_mutex);
+    flushLocked();
+
+    if (_droppedBytes > 0 && _publisher)
+        _publisher("stderr", std::format("\n[{} bytes of output were dropped, the limit is {} bytes per cell]\n", _droppedBytes, settings().maxCellBytes.load()));
+
+    _cellBytes    = 0;
+    _droppedBytes = 0;
+}
+
+void OutputCoalescer::detach()
+{
+    std::unique_lock lock(_mutex);
+    _publisher = {};
+    _buffer.clear();
+}
+
+void OutputCoalescer::flushLocked()
+{
+    if (_buffer.empty())
+        return;
+
+    // the buffer is emptied first, output that fails to publish is not retried
+    const std::string text = std::exchange(_buffer, {});
+
+    // publishing under the lock keeps the order of concurrent flushes
+    if (_publisher)
+        _publisher(_name, text);
+}
+
+void OutputCoalescer::runFlusher(std::stop_token stopToken)
+{
+    std::unique_lock lock(_mutex);
+
+    while (!stopToken.stop_requested()) {
+        // sleep until output is buffered
+        _wakeFlusher.wait(lock, stopToken, [this]() { return !_buffer.empty(); });
+
+        if (stopToken.stop_requested())
+            break;
+
+        const auto deadline = _firstBufferedWrite + std::chrono::milliseconds(settings().flushIntervalMs.load());
+
+        // returns early when the buffer is flushed by a writer in the meantime
+        const auto firstWrite = _firstBufferedWrite;
+        if (_wakeFlusher.wait_until(lock, stopToken, deadline, [this, firstWrite]() { return _buffer.empty() || _firstBufferedWrite != firstWrite; }))
+            continue;
+
+        if (stopToken.stop_requested())
+            break;
+
+        // an exception would terminate the process on this thread
+        try {
+            flushLocked();
+        }
+        catch (const std::exception& e) {
+            qWarning() << "OutputCoalescer: cannot publish output:" << e.what();
+        }
+        catch (...) {
+            qWarning() << "OutputCoalescer: cannot publish output";
+        }
+    }
+}
+
+namespace mvstudio_core {
+
+    void register_output_coalescer(pybind11::module_& m)
+    {
+        py::class_<OutputStream>(m, "OutputStream")
+            .def("write", &OutputStream::write, py::arg("text"))
+            .def("flush", &OutputStream::flush)
+            .def("isatty", [](const OutputStream&) { return false; })
+            .def("writable", [](const OutputStream&) { return true; })
+            .def("readable", [](const OutputStream&) { return false; })
+            .def_property_readonly("name", &OutputStream::name)
+            .def_property_readonly("encoding", [](const OutputStream&) { return "utf-8"; });
+
+        // Configure how the output of the calling kernel is coalesced, arguments that are None keep their value
+        m.def("configure_output", [](std::optional<std::uint64_t> flushBytes, std::optional<std::uint64_t> flushIntervalMs, std::optional<std::uint64_t> maxCellBytes) {
+            // each kernel installs the streams of its own coalescer
+            const py::object stdout_ = py::module_::import("sys").attr("stdout");
+            if (!py::isinstance<OutputStream>(stdout_))
+                throw std::runtime_error("configure_output: sys.stdout is not a kernel output stream");
+
+            auto& settings = stdout_.cast<const OutputStream&>().coalescer().settings();
+            if (flushBytes)         settings.flushBytes = *flushBytes;
+            if (flushIntervalMs)    settings.flushIntervalMs = *flushIntervalMs;
+            if (maxCellBytes)       settings.maxCellBytes = *maxCellBytes;
+
+            py::dict result;
+            result["flush_bytes"]       = settings.flushBytes.load();
+            result["flush_interval_ms"] = settings.flushIntervalMs.load();
+            result["max_cell_bytes"]    = settings.maxCellBytes.load();
+            return result;
+        },
+            py::arg("flush_bytes") = std::optional<std::uint64_t>(),
+            py::arg("flush_interval_ms") = std::optional<std::uint64_t>(),
+            py::arg("max_cell_bytes") = std::optional<std::uint64_t>()
+        );
+    }
+
+} // namespace mvstudio_core
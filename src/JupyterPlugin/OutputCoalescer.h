@@ -0,0 +1,104 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <atomic>
+#include <chrono>
+#include <condition_variable>
+#include <cstddef>
+#include <cstdint>
+#include <functional>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+/**
+ * Output coalescer
+ *
+ * Collects the stdout and stderr writes of the kernel and publishes them
+ * as few IOPub stream messages as possible, rather than one message per print.
+ * Buffered output is published
+ *  - when it exceeds flushBytes,
+ *  - flushIntervalMs after the first buffered write,
+ *  - on an explicit flush() and at the end of each cell.
+ * Output beyond maxCellBytes per cell is dropped and summarized at the end of the cell,
+ * truncated output ends at a UTF-8 character boundary.
+ * Each kernel has its own coalescer and settings, see mvstudio_core.configure_output.
+ *
+ * Writes to sys.stdout/sys.stderr go through OutputStream objects
+ * that the XeusInterpreter installs after configuring xeus-python.
+ */
+class OutputCoalescer
+{
+public:
+    struct Settings
+    {
+        std::atomic<std::uint64_t> flushBytes       = 8'192;
+        std::atomic<std::uint64_t> flushIntervalMs  = 100;
+        std::atomic<std::uint64_t> maxCellBytes     = 1'048'576;    /** 0 is unlimited */
+    };
+
+    using Publisher = std::function<void(const std::string& name, const std::string& text)>;
+
+    explicit OutputCoalescer(Publisher publisher);
+    ~OutputCoalescer();
+
+    void write(const std::string& name, const std::string& text);
+    void flush();
+
+    /** Publishes what is buffered, summarizes dropped output and resets the per cell limit */
+    void endCell();
+
+    /** Stops publishing, python may still hold the streams when the interpreter is gone */
+    void detach();
+
+    Settings& settings() { return _settings; }
+
+    /** Length of the longest prefix of text of at most maxBytes that does not split a UTF-8 sequence */
+    static std::size_t utf8Prefix(const std::string& text, std::size_t maxBytes);
+
+private:
+    void flushLocked();     // requires _mutex to be held
+    void runFlusher(std::stop_token stopToken);
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    Publisher                   _publisher;
+    Settings                    _settings;
+    std::mutex                  _mutex;
+    std::condition_variable_any _wakeFlusher;
+    std::string                 _name = {};             /** Stream of the buffered output */
+    std::string                 _buffer = {};
+    Clock::time_point           _firstBufferedWrite = {};
+    std::uint64_t               _cellBytes = 0;
+    std::uint64_t               _droppedBytes = 0;
+    std::jthread                _flusher;               /** Publishes output that is buffered longer than the flush interval */
+};
+
+/**
+ * File-like python object forwarding to an OutputCoalescer, used as sys.stdout and sys.stderr
+ */
+class OutputStream
+{
+public:
+    OutputStream(std::shared_ptr<OutputCoalescer> coalescer, std::string name) :
+        _coalescer(std::move(coalescer)), _name(std::move(name))
+    { }
+
+    std::size_t write(const std::string& text) { _coalescer->write(_name, text); return text.size(); }
+    void flush() { _coalescer->flush(); }
+    const std::string& name() const { return _name; }
+    OutputCoalescer& coalescer() const { return *_coalescer; }
+
+private:
+    std::shared_ptr<OutputCoalescer>    _coalescer;
+    std::string                         _name;
+};
+
+namespace mvstudio_core {
+    void register_output_coalescer(pybind11::module_& m);
+}
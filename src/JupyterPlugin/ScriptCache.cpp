@@ -0,0 +1,63 @@
+#include "ScriptCache.h"
+
+#include <QDateTime>
+#include <QFileInfo>
+
+#include <fstream>
+#include <iterator>
+#include <mutex>
+#include <string>
+#include <unordered_map>
+#include <utility>
+
+namespace py = pybind11;
+
+namespace
+{
+    std::string readScript(const QString& scriptPath)
+    {
+        std::ifstream file(scriptPath.toStdString());
+        return std::string(std::istreambuf_iterator<char>(file), std::istreambuf_iterator<char>{});
+    }
+
+    struct CompiledScript
+    {
+        qint64      lastModified    = 0;
+        qint64      size            = 0;
+        std::string marshalledCode  = {};
+    };
+
+    std::mutex                                          compiledScriptsMutex;
+    std::unordered_map<std::string, CompiledScript>     compiledScripts;
+}
+
+py::object compileScript(const QString& scriptPath)
+{
+    const QFileInfo scriptInfo(scriptPath);
+    const std::string path      = scriptInfo.absoluteFilePath().toStdString();
+    const qint64 lastModified   = scriptInfo.lastModified().toMSecsSinceEpoch();
+    const qint64 size           = scriptInfo.size();
+
+    const py::module_ marshal = py::module_::import("marshal");
+
+    {
+        std::scoped_lock lock(compiledScriptsMutex);
+        if (const auto it = compiledScripts.find(path);
+            it != compiledScripts.end() && it->second.lastModified == lastModified && it->second.size == size) {
+            return marshal.attr("loads")(py::bytes(it->second.marshalledCode));
+        }
+    }
+
+    // bytes, such that python honors an encoding declaration in the script
+    py::object code = py::module_::import("builtins").attr("compile")(py::bytes(readScript(scriptPath)), path, "exec");
+
+    CompiledScript compiled;
+    compiled.lastModified   = lastModified;
+    compiled.size           = size;
+    compiled.marshalledCode = marshal.attr("dumps")(code).cast<std::string>();
+
+    std::scoped_lock lock(compiledScriptsMutex);
+    compiledScripts[path] = std::move(compiled);
+
+    return code;
+}
@@ -0,0 +1,18 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <QString>
+
+/**
+ * Script cache
+ *
+ * Scripts are compiled at most once per version of the file: the compiled scripts are keyed
+ * by absolute path and valid for one modification time and size of the file.
+ * Code objects belong to an interpreter, the cache holds them marshalled such that subinterpreters share it.
+ */
+
+/** Returns the code object of the script, must be called holding the GIL */
+pybind11::object compileScript(const QString& scriptPath);
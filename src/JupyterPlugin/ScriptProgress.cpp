@@ -0,0 +1,156 @@
+#include "ScriptProgress.h"
+
+#include <BackgroundTask.h>
+
+#include <QCoreApplication>
+#include <QDebug>
+#include <QMetaObject>
+#include <QTimer>
+
+#include <algorithm>
+#include <cstdint>
+
+namespace py = pybind11;
+
+namespace
+{
+    thread_local ScriptProgress* currentProgress = nullptr;
+    thread_local std::size_t currentRunIndex = 0;
+
+    QString taskName(const QString& scriptName, std::size_t numRuns)
+    {
+        if (numRuns == 1)
+            return QString("Script %1").arg(scriptName);
+
+        return QString("Script %1 (%2 runs)").arg(scriptName).arg(numRuns);
+    }
+}
+
+ScriptProgress::ScriptProgress(const QString& scriptName, std::size_t numRuns) :
+    _task(new mv::BackgroundTask(nullptr, taskName(scriptName, numRuns))),
+    _scriptName(scriptName),
+    _started(Clock::now()),
+    _runFractions(std::max<std::size_t>(numRuns, 1), 0.0)
+{
+    _task->setProgressMode(mv::Task::ProgressMode::Manual);
+    _task->setRunning();
+}
+
+ScriptProgress::~ScriptProgress()
+{
+    if (_task)
+        _task->deleteLater();
+}
+
+ScriptProgress* ScriptProgress::current()
+{
+    return currentProgress;
+}
+
+std::size_t ScriptProgress::currentRun()
+{
+    return currentRunIndex;
+}
+
+void ScriptProgress::setCurrent(ScriptProgress* progress, std::size_t run)
+{
+    currentProgress = progress;
+    currentRunIndex = run;
+}
+
+void ScriptProgress::report(std::size_t run, double fraction, const std::string& message)
+{
+    std::scoped_lock lock(_mutex);
+
+    if (run >= _runFractions.size())
+        return;
+
+    const double runFraction = std::clamp(fraction, 0.0, 1.0);
+    _fraction += (runFraction - _runFractions[run]) / static_cast<double>(_runFractions.size());
+    _runFractions[run] = runFraction;
+
+    if (!message.empty()) {
+        _message = QString::fromStdString(message);
+        if (_runFractions.size() > 1)
+            _message = QString("[%1/%2] %3").arg(run + 1).arg(_runFractions.size()).arg(_message);
+    }
+
+    scheduleUpdate();
+}
+
+void ScriptProgress::scheduleUpdate()
+{
+    // a pending update applies the latest report
+    if (_updatePending)
+        return;
+
+    _updatePending = true;
+
+    const auto sinceLastUpdate = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _lastUpdate);
+    const int delayMs          = static_cast<int>(std::max<std::int64_t>(0, (updateInterval - sinceLastUpdate).count()));
+
+    QMetaObject::invokeMethod(qApp, [self = shared_from_this(), delayMs]() {
+        QTimer::singleShot(delayMs, qApp, [self]() { self->apply(); });
+    }, Qt::QueuedConnection);
+}
+
+void ScriptProgress::apply()
+{
+    double fraction;
+    QString message;
+    {
+        std::scoped_lock lock(_mutex);
+        fraction        = _fraction;
+        message         = _message;
+        _updatePending  = false;
+        _lastUpdate     = Clock::now();
+    }
+
+    if (!_task)
+        return;
+
+    _task->setProgress(static_cast<float>(fraction));
+    if (!message.isEmpty())
+        _task->setProgressDescription(message);
+}
+
+void ScriptProgress::finish(std::size_t run)
+{
+    std::scoped_lock lock(_mutex);
+
+    if (run < _runFractions.size()) {
+        _fraction += (1.0 - _runFractions[run]) / static_cast<double>(_runFractions.size());
+        _runFractions[run] = 1.0;
+    }
+
+    if (++_numFinished < _runFractions.size()) {
+        scheduleUpdate();
+        return;
+    }
+
+    const auto elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(Clock::now() - _started);
+    qDebug() << "JupyterPlugin: script" << _scriptName << "finished" << _runFractions.size() << "run(s) in" << elapsed.count() << "ms";
+
+    QMetaObject::invokeMethod(qApp, [self = shared_from_this()]() {
+        if (self->_task)
+            self->_task->setFinished();
+    }, Qt::QueuedConnection);
+}
+
+namespace mvstudio_core {
+
+    void register_script_progress(pybind11::module_& m)
+    {
+        // Reports the progress of the running script as a fraction in [0, 1] with an optional message
+        // Returns False when not called from a script, e.g. from a notebook
+        m.def("report_progress", [](double fraction, const std::string& message) {
+            ScriptProgress* progress = ScriptProgress::current();
+            if (!progress)
+                return false;
+
+            progress->report(ScriptProgress::currentRun(), fraction, message);
+            return true;
+        }, py::arg("fraction"), py::arg("message") = std::string());
+    }
+
+} // namespace mvstudio_core
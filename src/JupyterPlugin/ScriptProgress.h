@@ -0,0 +1,74 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <QPointer>
+#include <QString>
+
+#include <chrono>
+#include <cstddef>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <vector>
+
+namespace mv {
+    class BackgroundTask;
+}
+
+/**
+ * Script progress
+ *
+ * Shows a script run as a ManiVault background task. The script reports its progress
+ * with mvstudio_core.report_progress(fraction, message) from its worker thread.
+ * Reports are coalesced: the latest one is applied to the task on the GUI thread,
+ * at most once per updateInterval.
+ *
+ * A batch of runs of the same script is shown as one task, its progress is the mean over the runs
+ * and messages are prefixed with the run they belong to.
+ *
+ * Create on the GUI thread and make it current on the thread that runs the script.
+ */
+class ScriptProgress : public std::enable_shared_from_this<ScriptProgress>
+{
+public:
+    static constexpr std::chrono::milliseconds updateInterval{ 100 };
+
+    explicit ScriptProgress(const QString& scriptName, std::size_t numRuns = 1);
+    ~ScriptProgress();
+
+    /** Called from any thread */
+    void report(std::size_t run, double fraction, const std::string& message);
+
+    /** Marks the run as done, the task is finished after the last run */
+    void finish(std::size_t run);
+
+    /** Progress of the script that runs on this thread, or nullptr */
+    static ScriptProgress* current();
+    static std::size_t currentRun();
+    static void setCurrent(ScriptProgress* progress, std::size_t run = 0);
+
+private:
+    void scheduleUpdate();  // requires _mutex to be held
+    void apply();           // on the GUI thread
+
+private:
+    using Clock = std::chrono::steady_clock;
+
+    QPointer<mv::BackgroundTask>    _task;
+    QString                         _scriptName;
+    Clock::time_point               _started;
+    std::mutex                      _mutex;
+    std::vector<double>             _runFractions;
+    double                          _fraction = 0.0;        /** Mean of the run fractions */
+    std::size_t                     _numFinished = 0;
+    QString                         _message = {};
+    bool                            _updatePending = false;
+    Clock::time_point               _lastUpdate = {};
+};
+
+namespace mvstudio_core {
+    void register_script_progress(pybind11::module_& m);
+}
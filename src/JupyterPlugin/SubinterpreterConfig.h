@@ -0,0 +1,33 @@
+#pragma once
+
+#undef slots
+#include <pybind11/subinterpreter.h>
+#define slots Q_SLOTS
+
+#include <cstring>
+
+/**
+ * Creates a subinterpreter that shares the GIL with the main interpreter
+ *
+ * The subinterpreter gives isolated namespaces, not parallelism: it has its own modules and globals,
+ * but python code runs in one interpreter at a time, as with the main GIL alone.
+ * Extension modules are still checked for subinterpreter support, such that a module that does not
+ * support it (like numpy, see tests/JupyterPluginTest.cpp) fails to import with an ImportError
+ * instead of being loaded into a second interpreter that it may corrupt.
+ *
+ * Must be called holding the GIL of the main interpreter.
+ */
+inline pybind11::subinterpreter create_shared_gil_subinterpreter()
+{
+    PyInterpreterConfig config;
+    std::memset(&config, 0, sizeof(config));
+    config.use_main_obmalloc                = 1;
+    config.allow_fork                       = 1;
+    config.allow_exec                       = 1;
+    config.allow_threads                    = 1;
+    config.allow_daemon_threads             = 1;
+    config.check_multi_interp_extensions    = 1;
+    config.gil                              = PyInterpreterConfig_SHARED_GIL;
+
+    return pybind11::subinterpreter::create(config);
+}
@@ -0,0 +1,95 @@
+#include "VariantConversion.h"
+
+#undef slots
+#include <pybind11/numpy.h>
+#define slots Q_SLOTS
+
+#include <algorithm>
+#include <cstdint>
+
+namespace py = pybind11;
+
+namespace
+{
+    py::object variant_to_pyobject(const QVariant& var)
+    {
+        switch (var.typeId()) {
+        case QMetaType::Int:
+            return py::int_(var.toInt());
+        case QMetaType::UInt:
+            return py::int_(var.toUInt());
+        case QMetaType::LongLong:
+            return py::int_(var.toLongLong());
+        case QMetaType::ULongLong:
+            return py::int_(var.toULongLong());
+        case QMetaType::Float:
+            return py::float_(var.toFloat());
+        case QMetaType::Double:
+            return py::float_(var.toDouble());
+        case QMetaType::Bool:
+            return py::bool_(var.toBool());
+        case QMetaType::Char:
+            return py::str(var.toChar().decomposition().toStdString());
+        case QMetaType::QString:
+            return py::str(var.toString().toStdString());
+        default:
+            return py::none();
+        }
+    }
+
+    template<typename T, typename Getter>
+    py::array variant_list_to_pyarray(const QVariantList& list, Getter get)
+    {
+        auto result = py::array_t<T>(list.size());
+        T* output   = static_cast<T*>(result.request().ptr);
+
+        for (qsizetype i = 0; i < list.size(); ++i)
+            output[i] = get(list[i]);
+
+        return result;
+    }
+
+    // Lists in which all entries share one numeric type become a typed numpy array,
+    // all other lists are converted entry by entry
+    py::object variant_list_to_pyobject(const QVariantList& list)
+    {
+        const int typeId = list.isEmpty() ? QMetaType::UnknownType : list.front().typeId();
+        const bool homogeneous = std::all_of(list.begin(), list.end(), [typeId](const QVariant& var) { return var.typeId() == typeId; });
+
+        if (homogeneous) {
+            switch (typeId) {
+            case QMetaType::Int:
+                return variant_list_to_pyarray<std::int32_t>(list, [](const QVariant& var) { return var.toInt(); });
+            case QMetaType::UInt:
+                return variant_list_to_pyarray<std::uint32_t>(list, [](const QVariant& var) { return var.toUInt(); });
+            case QMetaType::LongLong:
+                return variant_list_to_pyarray<std::int64_t>(list, [](const QVariant& var) { return var.toLongLong(); });
+            case QMetaType::ULongLong:
+                return variant_list_to_pyarray<std::uint64_t>(list, [](const QVariant& var) { return var.toULongLong(); });
+            case QMetaType::Float:
+                return variant_list_to_pyarray<float>(list, [](const QVariant& var) { return var.toFloat(); });
+            case QMetaType::Double:
+                return variant_list_to_pyarray<double>(list, [](const QVariant& var) { return var.toDouble(); });
+            case QMetaType::Bool:
+                return variant_list_to_pyarray<bool>(list, [](const QVariant& var) { return var.toBool(); });
+            default:
+                break;
+            }
+        }
+
+        py::list pyList;
+        for (const QVariant& item : list) {
+            pyList.append(variant_to_pyobject(item));
+        }
+
+        return pyList;
+    }
+}
+
+py::object property_to_pyobject(const QVariant& property)
+{
+    if (property.typeId() == QMetaType::QVariantList)
+        return variant_list_to_pyobject(property.toList());
+
+    return variant_to_pyobject(property);
+}
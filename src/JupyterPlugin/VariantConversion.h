@@ -0,0 +1,18 @@
+#pragma once
+
+#undef slots
+#include <pybind11/pybind11.h>
+#define slots Q_SLOTS
+
+#include <QVariant>
+
+/**
+ * Conversion of dataset properties to python
+ *
+ * Numbers, booleans and strings become the matching python objects, other types None.
+ * Variant lists whose entries share one numeric type become a typed numpy array,
+ * other lists a python list converted entry by entry.
+ */
+
+/** Returns the python object for the property value, must be called holding the GIL */
+pybind11::object property_to_pyobject(const QVariant& property);
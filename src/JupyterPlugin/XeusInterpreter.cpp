@@ -1,11 +1,16 @@
 #include "XeusInterpreter.h"
 
+#include "DataStreamComm.h"
 #include "JupyterPlugin.h"
+#include "KernelTrace.h"
+#include "OutputCoalescer.h"
 #include "PythonBuildVersion.h"
 
+#include <functional>
 #include <iostream>
 #include <stdexcept>
 #include <string>
+#include <string_view>
 
 #include <xeus/xhelper.hpp>
 #include <xeus/xcomm.hpp>
@@ -41,11 +46,40 @@ namespace {
     }
 }
 
-XeusInterpreter::XeusInterpreter(const std::string& pluginVersion):
+XeusInterpreter::XeusInterpreter(const std::string& pluginVersion, bool releaseGilAtStartup):
     xpyt::interpreter(false, false),
-    _pluginVersion(pluginVersion)
+    _pluginVersion(pluginVersion),
+    _dataStreamComms(std::make_unique<DataStreamComms>())
 {
-    m_release_gil_at_startup = false;
+    // User code runs on the interpreter thread of the XeusServer, 
+    // the GUI thread releases the GIL once the interpreter is configured.
+    // In a subinterpreter the GUI thread leaves the interpreter after starting the kernel instead
+    m_release_gil_at_startup = releaseGilAtStartup;
+}
+
+XeusInterpreter::~XeusInterpreter()
+{
+    if (_outputCoalescer)
+        _outputCoalescer->detach();
+}
+
+void XeusInterpreter::closeDataStreamComms()
+{
+    _dataStreamComms->clear();
+}
+
+void XeusInterpreter::installOutputStreams()
+{
+    _outputCoalescer = std::make_shared<OutputCoalescer>([this](const std::string& name, const std::string& text) {
+        publish_stream(name, text);
+    });
+
+    py::gil_scoped_acquire acquire;
+    py::module_::import("mvstudio_core");   // registers the OutputStream type
+
+    const py::module_ sys = py::module_::import("sys");
+    sys.attr("stdout") = py::cast(OutputStream(_outputCoalescer, "stdout"));
+    sys.attr("stderr") = py::cast(OutputStream(_outputCoalescer, "stderr"));
 }
 
 void XeusInterpreter::configure_impl()
@@ -57,7 +91,9 @@ void XeusInterpreter::configure_impl()
 
     try {
         xpyt::interpreter::configure_impl();
+        installOutputStreams();
         comm_manager().register_comm_target("echo_target", handle_comm_opened);
+        _dataStreamComms->registerTarget(comm_manager());
     }
     catch (const py::error_already_set& e)
     {
@@ -85,9 +121,19 @@ void XeusInterpreter::execute_request_impl(send_reply_callback cb,
     xeus::execute_request_config config,
     nl::json user_expressions)
 {
-    qDebug() << "Python: " << code.c_str();
+    if (auto* event = KernelTrace::current()) {
+        event->codeHash = std::hash<std::string_view>{}(code);
+        event->bytesIn  = code.size();
+    }
+
+    // the output of the cell is published before its reply
+    auto flushing_cb = [this, cb](nl::json reply) {
+        if (_outputCoalescer)
+            _outputCoalescer->endCell();
+        cb(std::move(reply));
+    };
 
-    xpyt::interpreter::execute_request_impl(cb,
+    xpyt::interpreter::execute_request_impl(flushing_cb,
         execution_counter,
         code,
         config,
@@ -5,8 +5,12 @@
 #include <xeus-python/xinterpreter.hpp>
 #define slots Q_SLOTS
 
+#include <memory>
 #include <string>
 
+class DataStreamComms;
+class OutputCoalescer;
+
 /**
  * This class wraps the xeus python interpreter 
  * and initializes the pybind11 data module
@@ -22,8 +26,11 @@ public:
     XeusInterpreter() = delete;
     XeusInterpreter(XeusInterpreter& xeusInterpreter) = delete;
     XeusInterpreter(XeusInterpreter&& xeusInterpreter) = delete;
-    XeusInterpreter(const std::string& pluginVersion);
-    ~XeusInterpreter() override = default;
+    XeusInterpreter(const std::string& pluginVersion, bool releaseGilAtStartup = true);
+    ~XeusInterpreter() override;
+
+    /** Destroys the open data stream comms, while the comm manager of the kernel still exists */
+    void closeDataStreamComms();
 
 private:
     void configure_impl() override;
@@ -37,5 +44,10 @@ private:
     nl::json kernel_info_request_impl() override;
 
 private:
-    std::string _pluginVersion = "";
+    void installOutputStreams();
+
+private:
+    std::string                         _pluginVersion = "";
+    std::shared_ptr<OutputCoalescer>    _outputCoalescer = {};   /** Coalesces stdout and stderr into few iopub messages */
+    std::unique_ptr<DataStreamComms>    _dataStreamComms;        /** Open data stream comms of this kernel */
 };
@@ -1,45 +1,151 @@
 #include "XeusKernel.h"
 
+#include "KernelTrace.h"
+#include "SubinterpreterConfig.h"
 #include "XeusInterpreter.h"
 #include "XeusServer.h"
 
+#include <QCoreApplication>
 #include <QDebug>
+#include <QDir>
+#include <QStandardPaths>
 
 #include <nlohmann/json_fwd.hpp>
 
 #include <xeus/xeus_context.hpp>
+#include <xeus/xguid.hpp>
 #include <xeus/xhistory_manager.hpp>
 #include <xeus/xkernel.hpp>
 #include <zmq.hpp>
 
 #include <filesystem>
+#include <atomic>
 #include <fstream>
 #include <memory>
+#include <optional>
 #include <string>
 
-void XeusKernel::startKernel(const std::string& connection_path, const std::string& pluginVersion, const std::string& kernelWorkingDirectory)
+namespace
+{
+    // Jupyter connects to ipc://<ip>-<port>, unix socket paths are limited to about 100 characters
+    constexpr std::size_t maxIpcPathLength = 100;
+
+    // Numbers the kernels of this process, for distinct ipc socket paths
+    std::atomic_int numKernels = 0;
+
+    // Connection config for ipc sockets, the "ip" is the path prefix of the socket files
+    std::optional<xeus::xkernel_configuration> ipc_configuration()
+    {
+#ifdef Q_OS_LINUX
+        QString socketDir = QStandardPaths::writableLocation(QStandardPaths::RuntimeLocation);
+        if (socketDir.isEmpty())
+            socketDir = QDir::tempPath();
+
+        const QString socketName = QString("mvstudio-kernel-%1-%2").arg(QCoreApplication::applicationPid()).arg(numKernels++);
+        const std::string prefix = QDir(socketDir).filePath(socketName).toStdString();
+
+        if (prefix.size() + 2 > maxIpcPathLength) {
+            qWarning() << "XeusKernel: ipc socket path is too long, using tcp instead:" << prefix.c_str();
+            return std::nullopt;
+        }
+
+        xeus::xkernel_configuration config;
+        config.m_transport          = "ipc";
+        config.m_ip                 = prefix;
+        config.m_control_port       = "1";
+        config.m_shell_port         = "2";
+        config.m_stdin_port         = "3";
+        config.m_iopub_port         = "4";
+        config.m_hb_port            = "5";
+        config.m_signature_scheme   = "hmac-sha256";
+        config.m_key                = xeus::new_xguid();
+
+        return config;
+#else
+        qWarning() << "XeusKernel: the ipc transport is only available on Linux, using tcp instead";
+        return std::nullopt;
+#endif
+    }
+}
+
+XeusKernel::~XeusKernel()
+{
+    // the comms of the interpreter unregister from the comm manager, which the kernel destroys before its interpreter
+    if (m_interpreter)
+        m_interpreter->closeDataStreamComms();
+
+    if (!m_subinterpreter)
+        return;
+
+    // The interpreter is destroyed in its subinterpreter, which is ended afterwards
+    {
+        py::subinterpreter_scoped_activate activate(*m_subinterpreter);
+        m_kernel.reset();
+    }
+
+    m_subinterpreter.reset();
+}
+
+void XeusKernel::startKernel(const std::string& connection_path, const std::string& pluginVersion, const std::string& kernelWorkingDirectory, bool useIpc)
 {
     using context_type = xeus::xcontext_impl<zmq::context_t>;
 
-    auto interpreter = std::make_unique<XeusInterpreter>(pluginVersion);
-    xpyt::interpreter* interpreter_ptr = interpreter.get();
+    const std::int64_t startNs = KernelTrace::now();
+    std::optional<KernelTrace::ScopedPhase> phase(std::in_place, "create kernel");
+
+    // The kernel is created and configured in its subinterpreter, the server takes it from here
+    std::optional<py::subinterpreter_scoped_activate> activate;
+    if (m_ownInterpreter) {
+        try {
+            py::gil_scoped_acquire acquire;
+            m_subinterpreter = std::make_unique<py::subinterpreter>(create_shared_gil_subinterpreter());
+        }
+        catch (const std::exception& ex) {
+            qWarning() << "Cannot create subinterpreter for xeus kernel: " << ex.what();
+            return;
+        }
+
+        activate.emplace(*m_subinterpreter);
+    }
+
+    auto interpreter = std::make_unique<XeusInterpreter>(pluginVersion, /*releaseGilAtStartup*/ !m_ownInterpreter);
+    XeusInterpreter* interpreter_ptr = interpreter.get();
+
+    const std::optional<xeus::xkernel_configuration> ipcConfig = useIpc ? ipc_configuration() : std::nullopt;
 
     try {
-        m_kernel = std::make_unique<xeus::xkernel>(
-            /*config: not used here */
-            /*user_name      */ xeus::get_user_name(),
-            /*context        */ std::make_unique<context_type>(),
-            /*interpreter    */ std::move(interpreter),
-            /*server_builder */ make_XeusServer,
-            /*history_manager*/ xeus::make_in_memory_history_manager(),
-            /*logger         */ nullptr
-        );
+        if (ipcConfig) {
+            m_kernel = std::make_unique<xeus::xkernel>(
+                /*config         */ *ipcConfig,
+                /*user_name      */ xeus::get_user_name(),
+                /*context        */ std::make_unique<context_type>(),
+                /*interpreter    */ std::move(interpreter),
+                /*server_builder */ make_XeusServer,
+                /*history_manager*/ xeus::make_in_memory_history_manager(),
+                /*logger         */ nullptr
+            );
+        }
+        else {
+            m_kernel = std::make_unique<xeus::xkernel>(
+                /*config: generated with random tcp ports */
+                /*user_name      */ xeus::get_user_name(),
+                /*context        */ std::make_unique<context_type>(),
+                /*interpreter    */ std::move(interpreter),
+                /*server_builder */ make_XeusServer,
+                /*history_manager*/ xeus::make_in_memory_history_manager(),
+                /*logger         */ nullptr
+            );
+        }
     } catch (const std::exception& ex) {
         qDebug() << "Cannot create xeus kernel: " << ex.what();
         m_kernel.reset();
         return;
     }
 
+    m_interpreter = interpreter_ptr;
+
+    phase.emplace("write connection file");
+
     // Save the config that was generated
     const auto& kernel_config           = m_kernel->get_config();
     nlohmann::json kernel_spec          = {};
@@ -61,8 +167,12 @@ void XeusKernel::startKernel(const std::string& connection_path, const std::stri
     qDebug() << "Writing connection config to " << connection_path;
     std::ofstream configFile(connection_path);
     configFile << kernel_spec;
+    configFile.close();
 
+    // configures the interpreter and starts the server
+    phase.emplace("start kernel");
     m_kernel->start();
+    phase.reset();
 
     if (!kernelWorkingDirectory.empty() && std::filesystem::exists(kernelWorkingDirectory))
     {
@@ -75,10 +185,21 @@ void XeusKernel::startKernel(const std::string& connection_path, const std::stri
             nl::json::object()              // empty user_expressions
         );
     }
-    
+
+    qInfo() << "XeusKernel: started in" << (KernelTrace::now() - startNs) / 1'000'000 << "ms, see mvstudio_core.startup_timings()";
 }
 
 void XeusKernel::stopKernel()
 {
+    if (!m_kernel)
+        return;
+
     m_kernel->stop();
+
+    // zmq leaves the ipc socket files behind, jupyter does not clean them up for an existing kernel
+    if (const auto& kernel_config = m_kernel->get_config(); kernel_config.m_transport == "ipc") {
+        std::error_code ec;
+        for (const auto& port : { kernel_config.m_control_port, kernel_config.m_shell_port, kernel_config.m_stdin_port, kernel_config.m_iopub_port, kernel_config.m_hb_port })
+            std::filesystem::remove(kernel_config.m_ip + "-" + port, ec);
+    }
 }
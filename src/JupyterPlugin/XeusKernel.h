@@ -2,9 +2,15 @@
 
 #include <xeus/xkernel.hpp>
 
+#undef slots
+#include <pybind11/subinterpreter.h>
+#define slots Q_SLOTS
+
 #include <memory>
 #include <string>
 
+class XeusInterpreter;
+
 /**
  * Xeus kernel class 
  * 
@@ -16,6 +22,9 @@
  *
  *  - launches a kernel and interpreter and 0MQ comms
  *  - 0MQ comms run is a Qt WorkerThread and responds to shell & control requests (need also to handle stdin requests)
+ *  - on Linux the 0MQ sockets can use the ipc transport instead of tcp on localhost
+ *  - additional kernels run in their own subinterpreter for an isolated namespace, not for parallelism:
+ *    it shares the GIL with the main interpreter, and modules without subinterpreter support cannot be imported
  *
  * External dependencies are xeus
  *
@@ -25,10 +34,16 @@ class XeusKernel
 {
 
 public: 
+    /** With ownInterpreter the kernel runs in a new subinterpreter, otherwise in the main interpreter */
+    explicit XeusKernel(bool ownInterpreter = false) : m_ownInterpreter(ownInterpreter) { }
+    ~XeusKernel();
 
-    void startKernel(const std::string& connection_path, const std::string& pluginVersion, const std::string& kernelWorkingDirectory = "");
+    void startKernel(const std::string& connection_path, const std::string& pluginVersion, const std::string& kernelWorkingDirectory = "", bool useIpc = false);
     void stopKernel();
 
 private:
-    std::unique_ptr<xeus::xkernel> m_kernel = {};
+    bool                                        m_ownInterpreter = false;
+    std::unique_ptr<pybind11::subinterpreter>   m_subinterpreter = {};  /** Owned subinterpreter, destroyed after the kernel */
+    std::unique_ptr<xeus::xkernel>              m_kernel = {};
+    XeusInterpreter*                            m_interpreter = nullptr;    /** Owned by m_kernel */
 };
\ No newline at end of file
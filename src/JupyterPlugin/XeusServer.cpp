@@ -1,40 +1,433 @@
 #include "XeusServer.h"
 
+#include "BindingUtils.h"
+#include "KernelTrace.h"
+
+#include <QCoreApplication>
+#include <QDeadlineTimer>
 #include <QDebug>
-#include <QTimer>
+#include <QEvent>
+#include <QThread>
+#include <QThreadPool>
+
+#undef slots
+#include <pybind11/pybind11.h>
+#include <pybind11/subinterpreter.h>
+#define slots Q_SLOTS
 
 #include <xeus/xeus_context.hpp>
 #include <xeus/xkernel_configuration.hpp>
 
+#include <openssl/evp.h>
+#include <openssl/hmac.h>
+#include <zmq.hpp>
+
+#include <algorithm>
+#include <array>
+#include <optional>
+#include <stdexcept>
+#include <string>
+#include <string_view>
+#include <utility>
+
+namespace py = pybind11;
+
+namespace
+{
+    // Control message that only wakes the poller, it is not handled by the kernel
+    constexpr const char* wakeMessageType = "mvstudio_wake_request";
+
+    // Longest time in ns the poller drains messages before it sends queued replies
+    constexpr qint64 drainTimeSlice = 20'000'000;
+
+    constexpr qint64 oneSecond = 1'000'000'000;
+
+    // How long the server waits for running user code when stopping
+    constexpr unsigned long stopTimeoutMs = 2000;
+
+    // Waits at most timeoutMs for thread to finish, returns whether it did
+    // Running user code may wait for the GUI thread to access ManiVault,
+    // so on the GUI thread these calls are handled while waiting
+    bool waitForThread(QThread* thread, unsigned long timeoutMs)
+    {
+        auto* app = QCoreApplication::instance();
+
+        if (!app || QThread::currentThread() != app->thread())
+            return thread->wait(timeoutMs);
+
+        const QDeadlineTimer deadline(timeoutMs);
+        while (!thread->wait(10)) {
+            if (deadline.hasExpired())
+                return false;
+
+            QCoreApplication::sendPostedEvents(app, QEvent::MetaCall);
+        }
+
+        return true;
+    }
+
+    std::string messageType(const xeus::xmessage& msg)
+    {
+        return msg.header().value("msg_type", std::string());
+    }
+
+    // Endpoint the jupyter client connects to, ipc endpoints are <ip>-<port>
+    std::string endPoint(const xeus::xkernel_configuration& config, const std::string& port)
+    {
+        if (config.m_transport == "ipc")
+            return config.m_transport + "://" + config.m_ip + "-" + port;
+
+        return config.m_transport + "://" + config.m_ip + ":" + port;
+    }
+
+    // Hex encoded HMAC of the message frames, as the jupyter protocol signs messages, e.g. with hmac-sha256
+    std::string signature(const std::string& scheme, const std::string& key, const std::array<std::string, 4>& frames)
+    {
+        if (key.empty())
+            return {};
+
+        const EVP_MD* digest = EVP_get_digestbyname(scheme.substr(scheme.find('-') + 1).c_str());
+        if (!digest)
+            throw std::runtime_error("XeusServer: unsupported signature scheme " + scheme);
+
+        std::string data;
+        for (const auto& frame : frames)
+            data += frame;
+
+        std::array<unsigned char, EVP_MAX_MD_SIZE> mac = {};
+        unsigned int macSize = 0;
+        HMAC(digest, key.data(), static_cast<int>(key.size()), reinterpret_cast<const unsigned char*>(data.data()), data.size(), mac.data(), &macSize);
+
+        constexpr const char* hexDigits = "0123456789abcdef";
+        std::string hex;
+        for (unsigned int i = 0; i < macSize; ++i) {
+            hex += hexDigits[mac[i] >> 4];
+            hex += hexDigits[mac[i] & 0xf];
+        }
+
+        return hex;
+    }
+
+    KernelTrace::Event trace_event(const xeus::xmessage& msg, std::int64_t receivedNs)
+    {
+        KernelTrace::Event event;
+        event.setMsgId(msg.header().value("msg_id", std::string()));
+        event.setMsgType(messageType(msg));
+        event.receivedNs    = receivedNs;
+        event.startNs       = KernelTrace::now();
+        return event;
+    }
+}
+
+// Activated for the lifetime of the interpreter thread, the GIL is released while idle
+struct XeusServer::InterpreterScope
+{
+    explicit InterpreterScope(const py::subinterpreter& interpreter) :
+        activation(interpreter)
+    { }
+
+    py::subinterpreter_scoped_activate  activation;
+    py::gil_scoped_release              release;
+};
+
 XeusServer::XeusServer(xeus::xcontext& context, const xeus::xconfiguration& config, nl::json::error_handler_t eh) :
-    xserver_zmq(context, config, eh)
+    xserver_zmq(context, config, eh),
+    m_interpreter(current_interpreter())
+{
+    // The poller blocks until a message arrives, other threads wake it through the control channel
+    const auto* kernelConfig = std::get_if<xeus::xkernel_configuration>(&config);
+    if (!kernelConfig)
+        throw std::runtime_error("XeusServer: a kernel configuration is needed to wake the poller");
+
+    m_wakeSignatureScheme   = kernelConfig->m_signature_scheme;
+    m_wakeKey               = kernelConfig->m_key;
+    m_wakeSocket            = std::make_unique<zmq::socket_t>(context.get_wrapped_context<zmq::context_t>(), zmq::socket_type::dealer);
+    m_wakeSocket->set(zmq::sockopt::linger, 0);
+    m_wakeSocket->connect(endPoint(*kernelConfig, kernelConfig->m_control_port));
+
+    m_pollThread = QThread::create([this]() { pollChannels(); });
+    m_pollThread->setObjectName("XeusServerPoller");
+
+    m_interpreterThread = new QThread();
+    m_interpreterThread->setObjectName("XeusInterpreter");
+
+    m_interpreterContext = new QObject();
+    m_interpreterContext->moveToThread(m_interpreterThread);
+    connect(m_interpreterThread, &QThread::finished, m_interpreterContext, &QObject::deleteLater);
+
+    // both signals are emitted on the interpreter thread
+    if (inSubinterpreter()) {
+        connect(m_interpreterThread, &QThread::started, m_interpreterContext, [this]() { enterInterpreter(); }, Qt::DirectConnection);
+        connect(m_interpreterThread, &QThread::finished, m_interpreterContext, [this]() { leaveInterpreter(); }, Qt::DirectConnection);
+    }
+}
+
+XeusServer::~XeusServer()
+{
+    // the poller may be stopping the server itself, which waits for the interpreter thread
+    m_stopPolling = true;
+    wakePoller();
+    if (waitForThread(m_pollThread, 2 * stopTimeoutMs))
+        delete m_pollThread;
+    else
+        qWarning() << "XeusServer: the poller thread did not finish in time and is left running";
+
+    m_interpreterThread->quit();
+    if (waitForThread(m_interpreterThread, stopTimeoutMs)) {
+        delete m_interpreterThread;
+        return;
+    }
+
+    // Deleting a running QThread aborts the application, so the thread is left running.
+    // It no longer leaves the interpreter on finishing, as this server is gone by then
+    qWarning() << "XeusServer: the interpreter thread did not finish in time and is left running";
+    m_interpreterThread->disconnect(m_interpreterContext);
+    static_cast<void>(m_interpreterScope.release());
+}
+
+bool XeusServer::onPollThread() const
+{
+    return QThread::currentThread() == m_pollThread;
+}
+
+bool XeusServer::inSubinterpreter() const
+{
+    return m_interpreter->id() != py::subinterpreter::main().id();
+}
+
+void XeusServer::enterInterpreter()
+{
+    m_interpreterScope = std::make_unique<InterpreterScope>(*m_interpreter);
+}
+
+void XeusServer::leaveInterpreter()
+{
+    m_interpreterScope.reset();
+}
+
+void XeusServer::pollChannels()
+{
+    while (!m_stopPolling)
+    {
+        auto msg = poll_channels(-1);
+
+        // Drain all ready messages, bounded so that queued replies are not held back
+        const qint64 sliceEnd = m_clock.nsecsElapsed() + drainTimeSlice;
+        while (msg && !m_stopPolling)
+        {
+            dispatchMessage(std::move(msg.value().first), msg.value().second);
+
+            if (m_clock.nsecsElapsed() >= sliceEnd)
+                break;
+
+            msg = poll_channels(0);
+        }
+
+        if (!m_stopPolling)
+            flushOutgoing();
+    }
+}
+
+void XeusServer::wakePoller()
 {
-    m_pollTimer = new QTimer();
-    m_pollTimer->setInterval(10);
+    const std::array<std::string, 4> frames = {
+        nl::json({
+            { "msg_id", "wake-" + std::to_string(m_numWakes++) },
+            { "msg_type", wakeMessageType },
+            { "session", "" },
+            { "username", "" },
+            { "date", "" },
+            { "version", "5.3" } }).dump(),
+        "{}",   // parent header
+        "{}",   // metadata
+        "{}"    // content
+    };
+
+    std::scoped_lock lock(m_wakeMutex);
+
+    try {
+        // a message is dropped if the socket cannot take it, e.g. while the poller still has earlier ones to read
+        m_wakeSocket->send(zmq::buffer(std::string_view("<IDS|MSG>")), zmq::send_flags::sndmore | zmq::send_flags::dontwait);
+        m_wakeSocket->send(zmq::buffer(signature(m_wakeSignatureScheme, m_wakeKey, frames)), zmq::send_flags::sndmore | zmq::send_flags::dontwait);
+        for (size_t i = 0; i < frames.size(); ++i)
+            m_wakeSocket->send(zmq::buffer(frames[i]), i + 1 < frames.size() ? zmq::send_flags::sndmore | zmq::send_flags::dontwait : zmq::send_flags::dontwait);
+    }
+    catch (const zmq::error_t& e) {
+        qWarning() << "XeusServer: cannot wake the poller:" << e.what();
+    }
+}
+
+void XeusServer::dispatchMessage(xeus::xmessage&& msg, xeus::channel c)
+{
+    if (c == xeus::channel::CONTROL && messageType(msg) == wakeMessageType)
+        return;
+
+    countDispatched();
+
+    if (c == xeus::channel::CONTROL)
+    {
+        // Control messages are handled right away, also while user code runs
+        KernelTrace::Event event = trace_event(msg, KernelTrace::now());
+
+        if (messageType(msg) == "interrupt_request")
+            interruptExecution();
+
+        on_received_control_msg(new xeus::xmessage(std::move(msg)));
 
-    connect(m_pollTimer, &QTimer::timeout, [this]() { 
-        
-        if (auto msg = poll_channels(0))
+        event.endNs = KernelTrace::now();
+        KernelTrace::instance().record(event);
+        return;
+    }
+
+    const qint64 receivedAt         = m_clock.nsecsElapsed();
+    const std::int64_t receivedNs   = KernelTrace::now();
+    auto pmsg                       = new xeus::xmessage(std::move(msg));
+
+    m_inFlight++;
+    QMetaObject::invokeMethod(m_interpreterContext, [this, pmsg, receivedAt, receivedNs]() {
+        const qint64 now        = m_clock.nsecsElapsed();
+        const qint64 latency    = now - receivedAt;
+        m_numShellHandled++;
+        m_totalLatencyNs += latency;
+        m_maxLatencyNs = std::max(m_maxLatencyNs.load(), latency);
+
+        if (m_interpreterThreadId == 0)
+            m_interpreterThreadId = PyThread_get_thread_ident();
+
+        KernelTrace::Event event = trace_event(*pmsg, receivedNs);
+        KernelTrace::setCurrent(&event);
+        KernelTrace::instance().takeBytesOut();
+
+        // Requests following a failed execution are aborted, see abort_queue_impl
+        if (m_abortListener && now < m_abortUntilNs)
+        {
+            m_abortListener(std::move(*pmsg));
+            delete pmsg;
+        }
+        else
         {
-            if (msg.value().second == xeus::channel::SHELL)
-                notify_shell_listener(std::move(msg.value().first));
-            else
-                notify_control_listener(std::move(msg.value().first));
+            m_abortListener = {};
+
+            const bool isExecute = messageType(*pmsg) == "execute_request";
+            m_executing = isExecute;
+            on_received_shell_msg(pmsg);
+            m_executing = false;
         }
+
+        event.endNs     = KernelTrace::now();
+        event.bytesOut  = KernelTrace::instance().takeBytesOut();
+        KernelTrace::setCurrent(nullptr);
+        KernelTrace::instance().record(event);
+
+        m_inFlight--;
+    }, Qt::QueuedConnection);
+}
+
+void XeusServer::flushOutgoing()
+{
+    OutgoingMessages outgoing;
+    {
+        std::scoped_lock lock(m_outgoingMutex);
+        outgoing.swap(m_outgoing);
+    }
+
+    for (auto& [msg, c] : outgoing)
+    {
+        if (c == xeus::channel::SHELL)
+            xserver_zmq::send_shell_impl(std::move(msg));
+        else
+            xserver_zmq::send_control_impl(std::move(msg));
+    }
+}
+
+void XeusServer::interruptExecution()
+{
+    const unsigned long threadId = m_interpreterThreadId;
+
+    if (!m_executing || threadId == 0)
+        return;
+
+    // Acquiring the GIL waits for the interpreter thread to yield it,
+    // which must not block the poller
+    QThreadPool::globalInstance()->start([this, threadId]() {
+        interpreter_gil_acquire acquire(*m_interpreter);
+        if (m_executing)
+            PyThreadState_SetAsyncExc(threadId, PyExc_KeyboardInterrupt);
     });
 }
 
-XeusServer::~XeusServer()
+void XeusServer::countDispatched()
+{
+    m_numDispatched++;
+    m_windowCount++;
+
+    const qint64 now = m_clock.nsecsElapsed();
+
+    if (now - m_windowStartNs < oneSecond)
+        return;
+
+    // a window without traffic in between counts as idle
+    m_messagesPerSecond     = now - m_windowStartNs < 2 * oneSecond ? m_windowCount : 0;
+    m_peakMessagesPerSecond = std::max(m_peakMessagesPerSecond, m_messagesPerSecond.load());
+    m_windowStartNs         = now;
+    m_windowCount           = 0;
+}
+
+void XeusServer::send_shell_impl(xeus::xmessage msg)
+{
+    if (onPollThread()) {
+        xserver_zmq::send_shell_impl(std::move(msg));
+        return;
+    }
+
+    queueOutgoing(std::move(msg), xeus::channel::SHELL);
+}
+
+void XeusServer::send_control_impl(xeus::xmessage msg)
 {
-    m_pollTimer->stop();
-    delete m_pollTimer;
+    if (onPollThread()) {
+        xserver_zmq::send_control_impl(std::move(msg));
+        return;
+    }
+
+    queueOutgoing(std::move(msg), xeus::channel::CONTROL);
+}
+
+void XeusServer::queueOutgoing(xeus::xmessage&& msg, xeus::channel c)
+{
+    bool wasEmpty = false;
+    {
+        std::scoped_lock lock(m_outgoingMutex);
+        wasEmpty = m_outgoing.empty();
+        m_outgoing.emplace_back(std::move(msg), c);
+    }
+
+    // the poller sends all queued replies once woken
+    if (wasEmpty)
+        wakePoller();
+}
+
+void XeusServer::publish_impl(xeus::xpub_message msg, xeus::channel c)
+{
+    std::scoped_lock lock(m_publishMutex);
+    xserver_zmq::publish_impl(std::move(msg), c);
+}
+
+void XeusServer::abort_queue_impl(const listener& l, long polling_interval)
+{
+    // The shell socket belongs to the poller, so instead of polling it here,
+    // shell requests reaching the interpreter within the interval are passed to l
+    m_abortListener = l;
+    m_abortUntilNs  = m_clock.nsecsElapsed() + static_cast<qint64>(polling_interval) * 1'000'000;
 }
 
 void XeusServer::start_impl(xeus::xpub_message message)
 {
     start_publisher_thread();
     start_heartbeat_thread();
-    m_pollTimer->start();
+    m_clock.start();
+    m_interpreterThread->start();
+    m_pollThread->start();
     publish(std::move(message), xeus::channel::SHELL);
 }
 
@@ -54,8 +447,26 @@ void XeusServer::on_received_shell_msg(xeus::xmessage* pmsg)
 
 void XeusServer::stop_impl()
 {
-    m_pollTimer->stop();
-    this->stop_channels(); 
+    // stop_impl is called on the poller thread when handling a shutdown request,
+    // the poller then leaves its loop after returning from the dispatch
+    m_stopPolling = true;
+    if (!onPollThread()) {
+        wakePoller();
+        if (!waitForThread(m_pollThread, stopTimeoutMs))
+            qWarning() << "XeusServer: the poller thread did not finish in time";
+    }
+
+    interruptExecution();
+    m_interpreterThread->quit();
+    if (!waitForThread(m_interpreterThread, stopTimeoutMs))
+        qWarning() << "XeusServer: the interpreter thread did not finish in time";
+
+    if (const qint64 numHandled = m_numShellHandled; numHandled > 0)
+        qDebug() << "XeusServer: dispatched" << m_numDispatched << "messages, mean shell latency"
+                 << m_totalLatencyNs / numHandled / 1000.0 << "us, max shell latency" << m_maxLatencyNs / 1000.0 << "us, peak"
+                 << m_peakMessagesPerSecond << "messages per second";
+
+    this->stop_channels();
 }
 
 std::unique_ptr<xeus::xserver> make_XeusServer(xeus::xcontext& context,
@@ -1,36 +1,64 @@
 #pragma once
 /**
- * Xeus server class 
- * 
+ * Xeus server class
+ *
  * Creates and communicates the ZeroMQ channels
  * needs to communicate with the Jupyter server.
- * 
- * see 
+ *
+ * see
  * 1) https://github.com/Slicer/SlicerJupyter/blob/master/JupyterKernel/xSlicerServer.cxx
  * 2.1) https://github.com/jupyter-xeus/xeus-qt/blob/main/src/xq_server.cpp
  * 2.2) https://github.com/jupyter-xeus/xeus-qt/blob/main/src/xq_qt_poller.cpp
  * 3) https://github.com/jupyter-xeus/xeus-zmq/blob/main/src/server/xserver_zmq_default.hpp
- * 
- * The xeus-qt example uses a separate poller thread
- * 
- * For simplicity the initial implementation is done with a QTimer (as in Slicer)
- * The timer interval is hardcoded to 10ms
+ *
+ * The xeus-qt example uses a separate poller thread, as does this server.
+ * Three threads are involved:
+ *  - The poller thread owns the shell and control sockets: it blocks in poll_channels,
+ *    handles control messages itself and sends the replies the interpreter queued.
+ *    zmq sockets may not be used by two threads at once, and xserver_zmq does not
+ *    expose its sockets (so their ZMQ_FD cannot be used with a QSocketNotifier).
+ *    Instead, the poller is woken by a signed wake message on the control channel,
+ *    sent when the interpreter queues a reply or when the server stops.
+ *  - The interpreter thread handles shell messages, i.e. runs the user code.
+ *    Calls into ManiVault are marshalled to the GUI thread by mvstudio_core.
+ *  - The GUI thread is not involved at all, and an idle kernel wakes up no thread.
+ * The poller drains all ready messages on both channels within a bounded time slice.
+ * An interrupt_request on the control channel raises a KeyboardInterrupt
+ * in the interpreter thread.
+ *
+ * The server runs user code in the python interpreter that is current when it is created.
+ * For a subinterpreter, the interpreter thread keeps a thread state of it while it runs.
  *
  * External dependencies are a xeus and xeus-zmq
  *
- *  - 
+ *  -
  * @authors B. van Lew
 */
 
+#include <atomic>
+#include <cstdint>
+#include <deque>
 #include <memory>
+#include <mutex>
+#include <string>
+#include <utility>
 
 #include <xeus-zmq/xserver_zmq.hpp>
 #include <xeus/xkernel_configuration.hpp>
 #include <xeus/xeus_context.hpp>
 
+#include <QElapsedTimer>
 #include <QObject>
 
-class QTimer;
+class QThread;
+
+namespace pybind11 {
+    class subinterpreter;
+}
+
+namespace zmq {
+    class socket_t;
+}
 
 class XeusServer : public QObject, public xeus::xserver_zmq
 {
@@ -48,7 +76,15 @@ public:
 
     ~XeusServer() override;
 
+    /** Number of messages dispatched in the last full second */
+    qint64 messagesPerSecond() const { return m_messagesPerSecond; }
+
 protected:
+    void send_shell_impl(xeus::xmessage msg) override;
+    void send_control_impl(xeus::xmessage msg) override;
+    void publish_impl(xeus::xpub_message msg, xeus::channel c) override;
+    void abort_queue_impl(const listener& l, long polling_interval) override;
+
     void start_impl(xeus::xpub_message message) override;
     void stop_impl() override;
 
@@ -58,7 +94,56 @@ private slots:
     void on_received_control_msg(xeus::xmessage* msg);
 
 private:
-    QTimer* m_pollTimer = nullptr;
+    void pollChannels();
+    void wakePoller();
+    void queueOutgoing(xeus::xmessage&& msg, xeus::channel c);
+    void dispatchMessage(xeus::xmessage&& msg, xeus::channel c);
+    void flushOutgoing();
+    void interruptExecution();
+    void countDispatched();
+
+    bool onPollThread() const;
+    bool inSubinterpreter() const;
+
+    void enterInterpreter();
+    void leaveInterpreter();
+
+private:
+    QThread*            m_pollThread = nullptr;         /** Owns the shell and control sockets */
+    QThread*            m_interpreterThread = nullptr;  /** Handles shell messages, i.e. runs user code */
+    QObject*            m_interpreterContext = nullptr; /** Lives in m_interpreterThread, target for queued shell messages */
+    std::atomic_bool    m_stopPolling = false;
+    std::atomic_int     m_inFlight = 0;                 /** Shell messages queued or being handled by the interpreter */
+    std::atomic_bool    m_executing = false;            /** The interpreter thread runs an execute_request */
+    std::atomic_ulong   m_interpreterThreadId = 0;      /** Python thread id of the interpreter thread */
+
+    struct InterpreterScope;
+    std::shared_ptr<pybind11::subinterpreter>   m_interpreter;                  /** Python interpreter that runs the user code */
+    std::unique_ptr<InterpreterScope>           m_interpreterScope = {};        /** Thread state of a subinterpreter, held by the interpreter thread */
+
+    using OutgoingMessages = std::deque<std::pair<xeus::xmessage, xeus::channel>>;
+    std::mutex          m_outgoingMutex;
+    OutgoingMessages    m_outgoing;                     /** Replies from the interpreter thread, sent by the poller */
+    std::mutex          m_publishMutex;                 /** Both threads publish on iopub */
+
+    std::mutex                      m_wakeMutex;
+    std::unique_ptr<zmq::socket_t>  m_wakeSocket;       /** Connected to the control channel, see wakePoller */
+    std::string                     m_wakeSignatureScheme = {};
+    std::string                     m_wakeKey = {};
+    std::uint64_t                   m_numWakes = 0;
+
+    listener            m_abortListener = {};           /** Set by abort_queue_impl, used on the interpreter thread only */
+    qint64              m_abortUntilNs = 0;
+
+    QElapsedTimer       m_clock;                        /** Measures the time from receiving to handling a message */
+    qint64              m_numDispatched = 0;
+    std::atomic<qint64> m_numShellHandled = 0;
+    std::atomic<qint64> m_totalLatencyNs = 0;
+    std::atomic<qint64> m_maxLatencyNs = 0;
+    qint64              m_windowStartNs = 0;            /** Start of the current one second throughput window */
+    qint64              m_windowCount = 0;
+    std::atomic<qint64> m_messagesPerSecond = 0;
+    qint64              m_peakMessagesPerSecond = 0;
 };
 
 std::unique_ptr<xeus::xserver> make_XeusServer(xeus::xcontext& context,
@@ -5,6 +5,7 @@ from .hierarchy import Hierarchy
 from .item import Item
 from .image import ImageItem
 from .cluster import ClusterItem, Cluster
+from .chunks import PointChunks
       
 
-__all__ = ("Hierarchy", "Item", "ImageItem", "ClusterItem", "Cluster")
+__all__ = ("Hierarchy", "Item", "ImageItem", "ClusterItem", "Cluster", "PointChunks")
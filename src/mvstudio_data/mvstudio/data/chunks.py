@@ -0,0 +1,46 @@
+import mvstudio_core
+import numpy as np
+from typing import Generator
+
+
+class PointChunks:
+    """
+    Row-wise chunks of a point data set that is too large 
+    to be transferred to python in one piece. 
+    Each chunk is at most as large as the transfer budget 
+    (see mvstudio_core.set_transfer_budget) and is only 
+    transferred once it is accessed.
+    """
+
+    def __init__(self, datasetId: str, estimate: dict):
+        self._datasetId = datasetId
+        self._shape = tuple(estimate["shape"])
+        num_rows, num_dims = self._shape
+        row_bytes = max(1, num_dims * estimate["itemsize"])
+        self._rows_per_chunk = max(1, estimate["budget"] // row_bytes) if estimate["budget"] > 0 else max(1, num_rows)
+
+    @property
+    def shape(self) -> tuple[int, int]:
+        """Shape (num_points, num_dims) of the complete data set"""
+        return self._shape
+
+    @property
+    def rows_per_chunk(self) -> int:
+        return self._rows_per_chunk
+
+    def __len__(self) -> int:
+        return -(-self._shape[0] // self._rows_per_chunk)
+
+    def __getitem__(self, index: int) -> np.ndarray:
+        if index < 0:
+            index += len(self)
+        if index < 0 or index >= len(self):
+            raise IndexError("chunk index out of range")
+        return mvstudio_core.get_data_chunk_for_item(self._datasetId, index * self._rows_per_chunk, self._rows_per_chunk)
+
+    def __iter__(self) -> Generator[np.ndarray, None, None]:
+        for index in range(len(self)):
+            yield self[index]
+
+    def __repr__(self) -> str:
+        return f'PointChunks({self._datasetId}, shape={self._shape}, chunks={len(self)}, rows_per_chunk={self._rows_per_chunk})'
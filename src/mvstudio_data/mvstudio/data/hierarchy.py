@@ -9,10 +9,12 @@ class Hierarchy:
     def __init__(self):
         self._dataType = "Unknown"
         self._hierarchy = []
+        self._clearIndexes()
         self._refresh()
 
     def _refresh(self) -> None:
         self._hierarchy = []
+        self._clearIndexes()
         self._top_level = mvstudio_core.get_top_level_guids()
         self._build_hierarchy() 
 
@@ -20,9 +22,31 @@ class Hierarchy:
         hierarchy_id = 1
         for guid_tuple in self._top_level:
             item_name = mvstudio_core.get_item_name(guid_tuple[1])
-            self._hierarchy.append(makeItem(self, guid_tuple, item_name, [hierarchy_id]))   
+            item = makeItem(self, guid_tuple, item_name, [hierarchy_id])
+            self._hierarchy.append(item)
+            self._indexItem(item)
             hierarchy_id += 1
 
+    def _clearIndexes(self) -> None:
+        self._items_by_id = {}
+        self._items_by_dataset_id = {}
+        self._items_by_name = {}
+        self._items_by_index = {}
+
+    def _indexItem(self, item: Item) -> None:
+        """Add an item and all its children to the lookup tables.
+        Items are visited depth-first so that the first entry for 
+        a (non-unique) name matches the order of a tree search
+        """
+        if item is None:
+            return
+        self._items_by_id[item.itemId] = item
+        self._items_by_dataset_id[item.datasetId] = item
+        self._items_by_name.setdefault(item.name, []).append(item)
+        self._items_by_index[tuple(item._hierarchy_id)] = item
+        for child in item.children():
+            self._indexItem(child)
+
     def refresh(self): 
         """Rebuild the DataHierarchy tree from the MvStudio
         """
@@ -32,31 +56,27 @@ class Hierarchy:
         """Return the Item corresponding
         to the data hierarchy guid 
         """
-        for item in filter(None, self.children()):
-            result = item.getItem(itemId)
-            if result is not None:
-                return result
-        return None
+        return self._items_by_id.get(itemId)
 
     def getItemByDataID(self, datasetId: str) -> Item:
         """Return the Item corresponding
         to the data set guid 
         """
-        for item in filter(None, self.children()):
-            result = item.getItemByDataID(datasetId)
-            if result is not None:
-                return result
-        return None
+        return self._items_by_dataset_id.get(datasetId)
 
     def getItemByName(self, name: str) -> Item:
         """Return the Item corresponding
-        to the data name 
+        to the data name. If several items share
+        the name, the first one in the tree is returned
         """
-        for item in filter(None, self.children()):
-            result = item.getItemByName(name)
-            if result is not None:
-                return result
-        return None
+        items = self.getItemsByName(name)
+        return items[0] if items else None
+
+    def getItemsByName(self, name: str) -> list[Item]:
+        """Return all Items with the data name,
+        in the order of the tree
+        """
+        return list(self._items_by_name.get(name, []))
     
     def getItemByIndex(self, index: list[int]) -> Item:
         """Get an item from the data hierarchy by 
@@ -71,12 +91,20 @@ class Hierarchy:
         Returns:
             DataHierarchyItem: _description_
         """
-        item = None
-        for child in filter(None, self.children()):
-            item = child.getItemByIndex(index)
-            if item is not None:
-                break
-        return item
+        return self._items_by_index.get(tuple(index))
+
+    @staticmethod
+    def resolve(guid: str) -> tuple[str, str] | None:
+        """Look up a data hierarchy item or data set guid in ManiVault
+        directly, without building the Python tree.
+
+        Args:
+            guid: Either a data hierarchy item guid or a data set guid
+
+        Returns:
+            tuple[str, str] | None: (item guid, data set guid) or None if not found
+        """
+        return mvstudio_core.resolve(guid)
     
     def addPointsItem(self, data: np.ndarray, name: str, parentDataId : str = "", dimensionNames : list[str] = list()) -> Item|None:
         """Add a new points data item
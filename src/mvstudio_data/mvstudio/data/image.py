@@ -1,8 +1,10 @@
 import mvstudio_core
 from .item import Item
+from .chunks import PointChunks
 import numpy.typing as npt
 import numpy as np
 import functools
+import warnings
 
 Image = npt.NDArray[np.float32]
 Images = list[Image] 
@@ -10,9 +12,11 @@ Images = list[Image]
 class ImageMixin:
     """Mixin for Item to create an Image Item"""
     @functools.cached_property
-    def image(self) -> np.ndarray:
+    def image(self) -> np.ndarray | PointChunks:
         """If this is an image return the image data in a numpy array
-            otherwise return np.empty([0])
+            otherwise return np.empty([0]).
+            If the image exceeds the transfer budget, the pixel data
+            is returned as PointChunks of shape (num_pixels, num_components)
         """
         # information is in the image metadata
         # TODO cache image array and add cache clear option
@@ -20,6 +24,11 @@ class ImageMixin:
             return np.empty([0])
         id = mvstudio_core.find_image_dataset(self.datasetId)
         if len(id) > 0:
+            estimate = mvstudio_core.estimate_transfer(self.datasetId, True)
+            if not estimate["within_budget"]:
+                warnings.warn(f"Image of {estimate['bytes']} bytes exceeds the transfer budget of {estimate['budget']} bytes, returning pixel chunks", ResourceWarning)
+                return PointChunks(self.datasetId, mvstudio_core.estimate_transfer(self.datasetId, False))
+
             array =  mvstudio_core.get_image_item(self.datasetId)
 
             return np.flipud(array)
@@ -2,9 +2,11 @@ import mvstudio_core
 from typing import Generator, Self, Any
 import numpy as np
 import numpy.typing as npt
+import warnings
 from enum import Enum
 from .factory import makeItem
 from .clusterbase import Cluster
+from .chunks import PointChunks
 
 class Item:
     """
@@ -17,11 +19,11 @@ class Item:
     def __init__(self, hierarchy, guid_tuple, name, hierarchy_id):
         self._hierarchy = hierarchy
         self._guid_tuple = guid_tuple  # contains the item guid and dataset guid
+        self._handle = None  # created on first access to the metadata, see handle
         self._name = name
         self._hierarchy_id = hierarchy_id
         self._selected = False
         self._children = []
-        self._data = None
         self._type = None
         self._setType()
         self._addChildren()
@@ -42,20 +44,6 @@ class Item:
                 self._type = Item.ItemType.Points
             case mvstudio_core.DataItemType.Cluster:
                 self._type = Item.ItemType.Cluster 
-        self._setData()
-
-    def _setData(self):
-        if self._type is Item.ItemType.Points:
-            data = mvstudio_core.get_data_for_item(self.datasetId)
-        # dependant on the data type 
-        # post process to a more pythonic representation
-        match self._type:
-            case Item.ItemType.Points:
-                self._data = data
-            case Item.ItemType.Image:
-                self._data = None
-            case Item.ItemType.Cluster:
-                self._data = None
     
     def children(self) -> Generator[Self, None, None]:
         """Generator for iterating over any children of this Item.
@@ -69,65 +57,44 @@ class Item:
             yield self._children[index]
             index += 1
 
+    def _isDescendant(self, item) -> bool:
+        """Whether item is this item or one of its children"""
+        return item is not None and item._hierarchy_id[:len(self._hierarchy_id)] == self._hierarchy_id
+
     def getItem(self, itemId : str) -> Self | None:
         """Return the DataHierarchy Item corresponding to the given
         hierarchy item ID. It can be the current item or a child item.
         """
-        if self.itemId == itemId:
-            return self
-        
-        for child in filter(None, self.children()):
-            item = child.getItem(itemId)
-            if item is not None:
-                return item
-        return None
+        item = self._hierarchy.getItem(itemId)
+        return item if self._isDescendant(item) else None
     
     def getItemByDataID(self, datasetId : str) -> Self | None:
         """Return the DataHierarchy Item corresponding to the given
         dataset ID. It can be the current item or a child item.
         """
-        if self.datasetId == datasetId:
-            return self
-        
-        for child in filter(None, self.children()):
-            item = child.getItemByDataID(datasetId)
-            if item is not None:
-                return item
-        return None
+        item = self._hierarchy.getItemByDataID(datasetId)
+        return item if self._isDescendant(item) else None
     
     def getItemByName(self, name) -> Self | None:
         """Return the DataHierarchy Item corresponding
         to the name. It can be the current item or a child item.
         """
-        if self._name == name:
-            return self
-        
-        for child in filter(None, self.children()):
-            item = child.getItemByName(name)
-            if item is not None:
+        for item in self._hierarchy.getItemsByName(name):
+            if self._isDescendant(item):
                 return item
         return None
     
-    # Yes this is very stupid! 
-    # Will optimize later...
     def getItemByIndex(self, index: list[int]) -> Self | None:
-        """Return an item matching the index or NOne
+        """Return an item matching the index or None
 
         Args:
-            index (list[int]): _description_
+            index (list[int]): Index path of the item, e.g. [2, 1, 2]
 
         Returns:
-            Self: _description_
+            Self: The item or None
         """
-        item = None
-        if self._hierarchy_id == index:
-            return self
-        
-        for child in filter(None, self.children()):
-            item = child.getItemByIndex(index)
-            if item is not None:
-                break
-        return item
+        item = self._hierarchy.getItemByIndex(index)
+        return item if self._isDescendant(item) else None
     
     def getSelection(self) -> np.ndarray:
         """Get the selection for a given dataset, specified using its dataset ID.
@@ -158,8 +125,46 @@ class Item:
         return mvstudio_core.set_linked_data(self.datasetId, target.datasetId, selectionMapping)
 
     @property
-    def points(self) -> np.ndarray:
-        return mvstudio_core.get_data_for_item(self.datasetId)
+    def points(self) -> np.ndarray | PointChunks:
+        """Return the point data as a numpy array of shape (num_points, num_dims).
+        If the data exceeds the transfer budget, the data is returned 
+        as PointChunks which transfer the data piece by piece
+        """
+        estimate = mvstudio_core.estimate_transfer(self.datasetId)
+        if estimate["within_budget"]:
+            return mvstudio_core.get_data_for_item(self.datasetId)
+
+        warnings.warn(f"Point data of {estimate['bytes']} bytes exceeds the transfer budget of {estimate['budget']} bytes, returning chunks", ResourceWarning)
+        return PointChunks(self.datasetId, estimate)
+
+    def pointsAsync(self):
+        """Start transferring the point data in the background.
+        Returns an awaitable when called from a running asyncio loop
+        (e.g. a notebook cell using await), otherwise a concurrent.futures.Future.
+        Raises MemoryError on completion if the data exceeds the transfer budget.
+        The future needs the GUI thread to complete, so calling its result() 
+        on the GUI thread while it is pending raises a RuntimeError
+        """
+        return mvstudio_core.get_data_for_item_async(self.datasetId)
+
+    def estimateTransfer(self) -> dict:
+        """Return the size in bytes and shape of the data transfer
+        for this item and whether it is within the transfer budget"""
+        return mvstudio_core.estimate_transfer(self.datasetId)
+
+    def dimensionStats(self, dims: list[int] | None = None, bins: int = 0) -> dict[str, np.ndarray]:
+        """Compute per-dimension statistics in ManiVault without copying the point data
+
+        Args:
+            dims: (optional) Indices of the dimensions to summarize. If None, all dimensions are used
+            bins: (optional) Number of histogram bins per dimension. If 0, no histograms are computed
+
+        Returns:
+            dict[str, np.ndarray]: Arrays "dims", "count", "min", "max", "mean" and "std", 
+            and "histogram" and "bin_edges" if bins > 0.
+            Dimensions without finite values have count 0 and NaN statistics and bin edges
+        """
+        return mvstudio_core.compute_dimension_stats(self.datasetId, dims, bins)
 
     @property
     def type(self) -> ItemType:
@@ -182,25 +187,32 @@ class Item:
         """Return the data type"""
         return self._type
 
+    @property
+    def handle(self) -> mvstudio_core.DatasetHandle:
+        """Return the native dataset handle"""
+        if self._handle is None:
+            self._handle = mvstudio_core.DatasetHandle(self.datasetId)
+        return self._handle
+
     @property
     def rawname(self) -> str:
         """Return the raw name"""
-        return mvstudio_core.get_item_rawname(self.datasetId)
+        return self.handle.rawname
 
     @property
     def rawsize(self) -> int:
         """Return the raw data size in bytes"""
-        return mvstudio_core.get_item_rawsize(self.datasetId)
+        return self.handle.rawsize
     
     @property
     def numdimensions(self) -> int:
         """Return the number of dimensions"""
-        return mvstudio_core.get_item_numdimensions(self.datasetId)
+        return self.handle.numdimensions
     
     @property
     def numpoints(self) -> int:
         """Return the numper of points"""
-        return mvstudio_core.get_item_numpoints(self.datasetId)
+        return self.handle.numpoints
 
     @property
     def properties(self) -> list[str]:
@@ -211,6 +223,11 @@ class Item:
         """Return the property with a given name"""
         return mvstudio_core.get_item_property(self.datasetId, name)
 
+    def getProperties(self) -> dict[str, Any]:
+        """Return all properties by name. Lists of 
+        numbers are returned as numpy arrays"""
+        return mvstudio_core.get_item_properties_dict(self.datasetId)
+
     def __str__(self) -> str:
         children_strs = [f'{"  "*(len(self._hierarchy_id)-1)}Item id: {self._hierarchy_id}, dataset id: {self.datasetId}, display name: {self.name}, type: {self.type}']
         for child in filter(None, self.children()):
@@ -47,9 +47,11 @@ class ExternalMappingKernelManager(MappingKernelManager):
             setattr(kernel, port_name, 0)
 
         #Connect to kernel started by ManiVault JupyterPlugin.
-        # retrieve from environment or arg
+        # the provisioner claimed one of the kernels, otherwise use the main kernel
         #connection_file = Path('D:/TempProj/DevBundle/Jupyter/install/Debug/external_kernels/ManiVault/connection.json')
-        connection_file = Path(os.environ["MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE"])
+        connection_file = getattr(kernel.provisioner, 'connection_file', None)
+        if connection_file is None:
+            connection_file = Path(os.environ["MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE"])
 
         if not connection_file.exists():
             _log.warning(f"Jupyter connection file '{connection_file}' does not exist.")
@@ -6,17 +6,54 @@ from pathlib import Path
 
 _log = logging.getLogger(__name__)
 
+# Connection files handed out to kernel sessions of this jupyter server
+_claimed_connection_files = set()
+
+
+def kernel_connection_files():
+    """The connection file of the main kernel, followed by those of the
+    additional kernels in subinterpreters: connection-1.json, connection-2.json, ...
+    """
+    main_file = Path(os.environ["MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE"])
+    additional = main_file.parent.glob(f"{main_file.stem}-*{main_file.suffix}")
+    numbered = [f for f in additional if f.stem.rsplit("-", 1)[1].isdigit()]
+    return [main_file] + sorted(numbered, key=lambda f: int(f.stem.rsplit("-", 1)[1]))
+
+
+def claim_connection_file():
+    """Returns the connection file of a kernel that no session uses yet.
+    When all kernels are in use, sessions share the main kernel.
+    """
+    connection_files = kernel_connection_files()
+    for connection_file in connection_files:
+        if connection_file.exists() and connection_file not in _claimed_connection_files:
+            _claimed_connection_files.add(connection_file)
+            return connection_file
+
+    return connection_files[0]
+
+
+def release_connection_file(connection_file):
+    """Makes the kernel of a connection file available to the next session"""
+    _claimed_connection_files.discard(connection_file)
+
 
 class ExistingProvisioner(KernelProvisionerBase):
     """
     A Kernel Provisioner that re-uses an existing kernel.
     The kernel connection file is set in the environment variable
-    'MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE'.
+    'MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE'. Each session is given its own
+    kernel as long as additional kernels are available, see claim_connection_file.
+    The connection uses either the "tcp" or, on Linux, the "ipc" transport,
+    in which case "ip" is the path prefix of the socket files.
     """
 
+    connection_file = None
+
     async def launch_kernel(self, cmd, **kwargs):
         # Connect to kernel started by ManiVault JupyterPlugin
-        connection_file = Path(os.environ["MANIVAULT_JUPYTERPLUGIN_CONNECTION_FILE"])
+        connection_file = claim_connection_file()
+        self.connection_file = connection_file
 
         if not connection_file.exists():
             _log.warning(f"Jupyter connection file '{connection_file}' does not exist.")
@@ -26,6 +63,7 @@ class ExistingProvisioner(KernelProvisionerBase):
             file_info = json.load(f)
 
         file_info["key"] = file_info["key"].encode()
+        file_info.setdefault("transport", "tcp")
         return file_info
 
     async def pre_launch(self, **kwargs):
@@ -53,5 +91,10 @@ class ExistingProvisioner(KernelProvisionerBase):
         if restart:
             _log.warning("Cannot restart kernel running in ManiVault JupyterPlugin.")
 
+    async def shutdown_requested(self, restart=False):
+        # a restart launches again and claims a kernel anew
+        release_connection_file(self.connection_file)
+
     async def cleanup(self, restart):
-        pass
\ No newline at end of file
+        release_connection_file(self.connection_file)
+        self.connection_file = None
\ No newline at end of file
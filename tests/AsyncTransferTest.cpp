@@ -0,0 +1,122 @@
+#include <future>
+#include <iostream>
+#include <stdexcept>
+#include <string>
+
+#include <QCoreApplication>
+#include <QThreadPool>
+
+#undef slots
+#include <pybind11/embed.h>
+#define slots Q_SLOTS
+
+#include "AsyncTransfer.h"
+
+namespace py = pybind11;
+
+namespace Test
+{
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        // The tasks of the pool need the GIL to complete
+        void waitForPool(QThreadPool& pool)
+        {
+            py::gil_scoped_release release;
+            pool.waitForDone();
+        }
+    }
+
+    // Needs the interpreter, see main
+    bool runAsyncTransfer()
+    {
+        bool success = true;
+
+        bool refused = false;
+        try {
+            submit_async([]() -> py::object { return py::none(); });
+        }
+        catch (const std::runtime_error&) {
+            refused = true;
+        }
+        success &= check(refused, "transfers are refused without a pool");
+
+        QThreadPool pool;
+        mvstudio_core::set_async_pool(&pool);
+
+        try {
+            py::dict scope;
+            scope["submit"] = py::cpp_function([](const py::object& value) { return submit_async([value]() { return value; }); });
+            scope["fail"]   = py::cpp_function([](const std::string& message) { return submit_async([message]() -> py::object { throw std::runtime_error(message); }); });
+            scope["divide"] = py::cpp_function([]() { return submit_async([]() -> py::object { return py::eval("1 / 0"); }); });
+
+            py::exec(R"(
+import asyncio
+import concurrent.futures
+
+def raises(function, error):
+    try:
+        function()
+    except error:
+        return True
+    return False
+
+async def awaitSubmit():
+    future = submit("awaited")
+    return isinstance(future, asyncio.Future), await future
+)", scope);
+
+            const auto holds = [&scope](const char* expression) { return py::eval(expression, scope).cast<bool>(); };
+
+            success &= check(holds("submit(42).result(timeout=10) == 42"), "the future returns the result of the work");
+            success &= check(holds("isinstance(submit(1), concurrent.futures.Future)"), "outside an event loop the future is a concurrent.futures.Future");
+            success &= check(holds("asyncio.run(awaitSubmit()) == (True, 'awaited')"), "in a running event loop the future is awaitable");
+
+            py::exec("failed = fail('no data').exception(timeout=10)", scope);
+            success &= check(holds("isinstance(failed, RuntimeError) and str(failed) == 'no data'"), "C++ exceptions of the work become a RuntimeError");
+            success &= check(holds("isinstance(divide().exception(timeout=10), ZeroDivisionError)"), "python exceptions of the work are passed on");
+
+            // While pending, the result cannot be waited for on the GUI thread, which completing it may need
+            {
+                int argc = 1;
+                char name[] = "JupyterPluginTest";
+                char* argv[] = { name, nullptr };
+                QCoreApplication app(argc, argv);
+
+                std::promise<void> release;
+                pool.setMaxThreadCount(1);
+                pool.start([blocked = release.get_future().share()]() { blocked.wait(); });
+
+                bool refusedOnGui = false;
+                try {
+                    py::exec("pending = submit('late')", scope);
+                    refusedOnGui = holds("raises(lambda: pending.result(timeout=0), RuntimeError) and raises(lambda: pending.exception(timeout=0), RuntimeError)");
+                }
+                catch (const py::error_already_set& e) {
+                    std::cout << "  " << e.what() << "\n";
+                }
+
+                release.set_value();
+                waitForPool(pool);
+
+                success &= check(refusedOnGui, "a pending future refuses result() and exception() on the GUI thread");
+                success &= check(holds("pending.result() == 'late'"), "a completed future returns its result on the GUI thread");
+            }
+        }
+        catch (const py::error_already_set& e) {
+            std::cout << "  " << e.what() << "\n";
+            success = false;
+        }
+
+        waitForPool(pool);
+        mvstudio_core::set_async_pool(nullptr);
+
+        return success;
+    }
+
+} // namespace Test
@@ -0,0 +1,253 @@
+#include <iostream>
+#include <string>
+
+#undef slots
+#include <pybind11/embed.h>
+#define slots Q_SLOTS
+
+namespace py = pybind11;
+
+namespace Test
+{
+    std::string importDataModules();
+
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        // Replaces the data hierarchy functions of the stub mvstudio_core by a fixed tree:
+        // A (B shared, C (D shared)), E shared
+        constexpr const char* fakeHierarchySource = R"(
+import enum
+import mvstudio_core
+
+mvstudio_core.DataItemType = enum.Enum("DataItemType", ["Image", "Points", "Cluster"])
+
+# data set guid: item guid, name and the data set guids of the children
+tree = {
+    "dA": ("iA", "A", ["dB", "dC"]),
+    "dB": ("iB", "shared", []),
+    "dC": ("iC", "C", ["dD"]),
+    "dD": ("iD", "shared", []),
+    "dE": ("iE", "shared", []),
+}
+topLevel = ["dA", "dE"]
+
+def guids(datasetIds):
+    return [(tree[datasetId][0], datasetId) for datasetId in datasetIds]
+
+def install():
+    mvstudio_core.get_top_level_guids = lambda: guids(topLevel)
+    mvstudio_core.get_item_children = lambda datasetId: guids(tree[datasetId][2])
+    mvstudio_core.get_item_name = lambda datasetId: tree[datasetId][1]
+    mvstudio_core.get_data_type = lambda datasetId: mvstudio_core.DataItemType.Points
+
+# lookups are expected to use the indexes of the hierarchy, not to walk ManiVault again
+def uninstall():
+    def unavailable(*args):
+        raise RuntimeError("the data hierarchy was walked again")
+    mvstudio_core.get_item_children = unavailable
+    mvstudio_core.get_item_name = unavailable
+
+install()
+
+from mvstudio.data import Hierarchy
+hierarchy = Hierarchy()
+uninstall()
+)";
+
+        // Replaces the point transfers of the stub mvstudio_core by a data set of 10 points with 3 float dimensions
+        constexpr const char* fakePointsSource = R"(
+import warnings
+import numpy as np
+import mvstudio_core
+
+data = np.arange(30, dtype=np.float32).reshape(10, 3)
+budget = 40
+requests = []
+
+def estimate_transfer(datasetId, *args):
+    return { "bytes": data.nbytes, "budget": budget, "within_budget": budget == 0 or data.nbytes <= budget, "shape": data.shape, "itemsize": data.itemsize }
+
+# like the native function, a chunk is clipped to the rows of the data set and checked against the budget
+def get_data_chunk_for_item(datasetId, startRow, numRows):
+    requests.append((startRow, numRows))
+    if budget > 0 and numRows * data.shape[1] * data.itemsize > budget:
+        raise RuntimeError("chunk exceeds the transfer budget")
+    return data[startRow:startRow + numRows].copy()
+
+mvstudio_core.estimate_transfer = estimate_transfer
+mvstudio_core.get_data_chunk_for_item = get_data_chunk_for_item
+mvstudio_core.get_data_for_item = lambda datasetId: data.copy()
+
+from mvstudio.data import Item, PointChunks
+
+def chunksFor(shape, budget):
+    return PointChunks("dA", { "shape": shape, "itemsize": 4, "budget": budget })
+
+def raises(function, error):
+    try:
+        function()
+    except error:
+        return True
+    return False
+)";
+    }
+
+    // Needs the interpreter, see main
+    bool runHierarchyIndex()
+    {
+        bool success = true;
+
+        const std::string error = importDataModules();
+        if (!error.empty()) {
+            std::cout << "  " << error << "\n";
+            return false;
+        }
+
+        try {
+            py::dict scope;
+            py::exec(fakeHierarchySource, scope);
+
+            const auto holds = [&scope](const char* expression) { return py::eval(expression, scope).cast<bool>(); };
+
+            success &= check(holds("hierarchy.getItem('iD').datasetId == 'dD'"), "items are found by item guid");
+            success &= check(holds("hierarchy.getItemByDataID('dC').itemId == 'iC'"), "items are found by data set guid");
+            success &= check(holds("hierarchy.getItemByIndex([1, 2, 1]).datasetId == 'dD'"), "items are found by index path");
+            success &= check(holds("hierarchy.getItem('missing') is None and hierarchy.getItemByDataID('missing') is None and hierarchy.getItemByIndex([3]) is None"), "unknown keys give None");
+
+            success &= check(holds("[item.datasetId for item in hierarchy.getItemsByName('shared')] == ['dB', 'dD', 'dE']"), "items sharing a name are listed in tree order");
+            success &= check(holds("hierarchy.getItemByName('shared').datasetId == 'dB'"), "the first item of a name is the first in the tree");
+            success &= check(holds("hierarchy.getItemsByName('missing') == [] and hierarchy.getItemByName('missing') is None"), "an unknown name gives no items");
+
+            // the lookups of an item are restricted to the item and its descendants
+            success &= check(holds("hierarchy.getItemByDataID('dC').getItemByName('shared').datasetId == 'dD'"), "an item finds a shared name among its descendants");
+            success &= check(holds("hierarchy.getItemByDataID('dA').getItemByDataID('dE') is None"), "an item does not find items outside its subtree");
+            success &= check(holds("hierarchy.getItemByDataID('dC').getItemByIndex([1, 2]).datasetId == 'dC'"), "an item finds itself");
+
+            // refresh rebuilds the indexes
+            py::exec(R"(
+install()
+tree["dF"] = ("iF", "shared", [])
+topLevel.append("dF")
+hierarchy.refresh()
+uninstall()
+)", scope);
+            success &= check(holds("hierarchy.getItemByDataID('dF').getItemByIndex([3]).itemId == 'iF'"), "refresh indexes new items");
+            success &= check(holds("[item.datasetId for item in hierarchy.getItemsByName('shared')] == ['dB', 'dD', 'dE', 'dF']"), "refresh does not duplicate the name index");
+        }
+        catch (const py::error_already_set& e) {
+            std::cout << "  " << e.what() << "\n";
+            success = false;
+        }
+
+        return success;
+    }
+
+    // Needs the interpreter, see main
+    bool runDatasetHandle()
+    {
+        bool success = true;
+
+        const std::string error = importDataModules();
+        if (!error.empty()) {
+            std::cout << "  " << error << "\n";
+            return false;
+        }
+
+        try {
+            py::dict scope;
+            py::exec(R"(
+import mvstudio_core
+
+handles = []
+
+class DatasetHandle:
+    def __init__(self, datasetId):
+        handles.append(datasetId)
+        self.rawname = "raw " + datasetId
+        self.rawsize = 120
+        self.numdimensions = 3
+        self.numpoints = 10
+
+stubHandle = mvstudio_core.DatasetHandle
+mvstudio_core.DatasetHandle = DatasetHandle
+)", scope);
+            py::exec(fakeHierarchySource, scope);
+
+            const auto holds = [&scope](const char* expression) { return py::eval(expression, scope).cast<bool>(); };
+
+            success &= check(holds("handles == []"), "building the hierarchy creates no handles");
+
+            py::exec("item = hierarchy.getItemByDataID('dC')", scope);
+            success &= check(holds("item.numpoints == 10 and item.numdimensions == 3 and item.rawsize == 120 and item.rawname == 'raw dC'"), "the metadata is read from the handle");
+            success &= check(holds("handles == ['dC'] and item.handle is item.handle"), "the handle is created once, on first access");
+
+            py::exec("mvstudio_core.DatasetHandle = stubHandle", scope);
+        }
+        catch (const py::error_already_set& e) {
+            std::cout << "  " << e.what() << "\n";
+            success = false;
+        }
+
+        return success;
+    }
+
+    // Needs the interpreter, see main
+    bool runPointChunks()
+    {
+        bool success = true;
+
+        const std::string error = importDataModules();
+        if (!error.empty()) {
+            std::cout << "  " << error << "\n";
+            return false;
+        }
+
+        try {
+            py::dict scope;
+            py::exec(fakePointsSource, scope);
+
+            const auto holds = [&scope](const char* expression) { return py::eval(expression, scope).cast<bool>(); };
+
+            // 40 bytes hold 3 rows of 12 bytes
+            py::exec("chunks = chunksFor(data.shape, budget)", scope);
+            success &= check(holds("chunks.rows_per_chunk == 3 and len(chunks) == 4 and chunks.shape == (10, 3)"), "chunks hold as many rows as fit in the budget");
+            success &= check(holds("requests == []"), "no data is transferred before a chunk is accessed");
+            success &= check(holds("np.array_equal(np.concatenate(list(chunks)), data)"), "the chunks concatenate to the data set");
+            success &= check(holds("requests == [(0, 3), (3, 3), (6, 3), (9, 3)]"), "each chunk is transferred once, within the budget");
+            success &= check(holds("np.array_equal(chunks[-1], data[9:])"), "negative indexes count from the last chunk");
+            success &= check(holds("raises(lambda: chunks[4], IndexError) and raises(lambda: chunks[-5], IndexError)"), "out of range chunks are refused");
+
+            success &= check(holds("len(chunksFor((10, 3), 0)) == 1 and chunksFor((10, 3), 0).rows_per_chunk == 10"), "without a budget the data set is one chunk");
+            success &= check(holds("len(chunksFor((0, 3), 40)) == 0 and list(chunksFor((0, 3), 0)) == []"), "an empty data set has no chunks");
+            success &= check(holds("chunksFor((10, 100), 40).rows_per_chunk == 1"), "a chunk holds at least one row");
+
+            // Item.points switches to chunks once the data set exceeds the budget
+            py::exec(R"(
+class PointsItem:
+    datasetId = "dA"
+    points = Item.points
+
+with warnings.catch_warnings(record=True) as caught:
+    warnings.simplefilter("always")
+    overBudget = PointsItem().points
+budget = 0
+withinBudget = PointsItem().points
+)", scope);
+            success &= check(holds("isinstance(overBudget, PointChunks) and caught[0].category is ResourceWarning"), "points over the budget are returned as chunks with a warning");
+            success &= check(holds("isinstance(withinBudget, np.ndarray) and np.array_equal(withinBudget, data)"), "points within the budget are returned as one array");
+        }
+        catch (const py::error_already_set& e) {
+            std::cout << "  " << e.what() << "\n";
+            success = false;
+        }
+
+        return success;
+    }
+
+} // namespace Test
@@ -0,0 +1,127 @@
+#include <cmath>
+#include <cstdint>
+#include <iostream>
+#include <limits>
+#include <numeric>
+#include <vector>
+
+#include "DimensionStats.h"
+
+namespace Test
+{
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        bool near(double a, double b, double tolerance = 1e-9)
+        {
+            return std::abs(a - b) <= tolerance * std::max(1.0, std::abs(b));
+        }
+
+        // Mean and population variance computed in two passes, as reference
+        std::pair<double, double> referenceMeanVariance(const std::vector<double>& values)
+        {
+            const double mean = std::accumulate(values.begin(), values.end(), 0.0) / static_cast<double>(values.size());
+
+            double sumSquares = 0;
+            for (const double value : values)
+                sumSquares += (value - mean) * (value - mean);
+
+            return { mean, sumSquares / static_cast<double>(values.size()) };
+        }
+    }
+
+    bool runDimensionStats()
+    {
+        bool success = true;
+        constexpr double nan = std::numeric_limits<double>::quiet_NaN();
+
+        // Merging the partial results of two row ranges gives the statistics of all rows
+        {
+            const std::vector<double> values = { 1e8 + 4, 1e8 + 7, 1e8 + 13, 1e8 + 16, 3.5, -2.0, 1e8 + 1 };
+
+            DimensionStats first(1), second(1), all(1);
+            for (size_t i = 0; i < values.size(); ++i) {
+                (i < 3 ? first : second).add(0, values[i]);
+                all.add(0, values[i]);
+            }
+
+            first.merge(second);
+
+            const auto [mean, variance] = referenceMeanVariance(values);
+            success &= check(first.count[0] == values.size(), "merge adds the counts");
+            success &= check(near(first.mean[0], mean) && near(first.mean[0], all.mean[0]), "merge gives the mean of all rows");
+            success &= check(near(first.m2[0] / values.size(), variance, 1e-6), "merge gives the variance of all rows");
+            success &= check(first.min[0] == -2.0 && first.max[0] == 1e8 + 16, "merge gives the min and max of all rows");
+        }
+
+        // Merging with an empty partial result changes nothing, in either direction
+        {
+            DimensionStats stats(1), empty(1);
+            stats.add(0, 2.0);
+            stats.add(0, 4.0);
+
+            DimensionStats emptyFirst(1);
+            emptyFirst.merge(stats);
+            stats.merge(empty);
+
+            success &= check(stats.count[0] == 2 && stats.mean[0] == 3.0, "merging an empty result keeps the statistics");
+            success &= check(emptyFirst.count[0] == 2 && emptyFirst.mean[0] == 3.0 && emptyFirst.min[0] == 2.0, "merging into an empty result copies the statistics");
+        }
+
+        // Non-finite values are skipped, a dimension without finite values has NaN statistics
+        {
+            // 3 rows, 2 dimensions: the second dimension only holds NaN and infinity
+            const std::vector<float> data = { 1.f, nan, 2.f, std::numeric_limits<float>::infinity(), 6.f, nan };
+
+            DimensionStats stats = compute_dimension_stats_impl(data.data(), 2, {}, 3, { 0, 1 });
+            const std::vector<double> stddev = stats.stddev();
+            stats.setEmptyToNaN();
+
+            success &= check(stats.count[0] == 3 && stats.count[1] == 0, "non-finite values are not counted");
+            success &= check(near(stats.mean[0], 3.0) && near(stddev[0], std::sqrt(14.0 / 3.0)), "mean and stddev of a dimension");
+            success &= check(std::isnan(stats.min[1]) && std::isnan(stats.max[1]) && std::isnan(stats.mean[1]) && std::isnan(stddev[1]), "an empty dimension has NaN statistics");
+
+            const std::vector<double> edges = dimension_bin_edges(stats, 2);
+            success &= check(edges[0] == 1.0 && edges[1] == 3.5 && edges[2] == 6.0, "bin edges span min to max");
+            success &= check(std::isnan(edges[3]) && std::isnan(edges[4]) && std::isnan(edges[5]), "an empty dimension has NaN bin edges");
+
+            const auto histograms = compute_dimension_histograms_impl(data.data(), 2, {}, 3, { 0, 1 }, stats, 2);
+            success &= check(histograms == std::vector<std::uint64_t>{ 2, 1, 0, 0 }, "histograms count finite values, the maximum falls in the last bin");
+        }
+
+        // Subsets and selected dimensions, over enough rows to be split in blocks
+        {
+            constexpr size_t numRows = 50'000, numDimensions = 3;
+
+            std::vector<std::uint16_t> data(numRows * numDimensions);
+            for (size_t row = 0; row < numRows; ++row)
+                for (size_t dim = 0; dim < numDimensions; ++dim)
+                    data[row * numDimensions + dim] = static_cast<std::uint16_t>((row * (dim + 1)) % 1000);
+
+            std::vector<std::uint32_t> rowIndices;
+            for (std::uint32_t row = 0; row < numRows; row += 2)
+                rowIndices.push_back(row);
+
+            const DimensionStats stats = compute_dimension_stats_impl(data.data(), numDimensions, rowIndices, rowIndices.size(), { 2 });
+
+            std::vector<double> expected;
+            for (const auto row : rowIndices)
+                expected.push_back(data[row * numDimensions + 2]);
+            const auto [mean, variance] = referenceMeanVariance(expected);
+
+            success &= check(stats.count.size() == 1 && stats.count[0] == rowIndices.size(), "only the selected rows and dimensions are used");
+            success &= check(near(stats.mean[0], mean) && near(stats.stddev()[0], std::sqrt(variance), 1e-6), "block results merge to the statistics of the subset");
+
+            const auto histograms = compute_dimension_histograms_impl(data.data(), numDimensions, rowIndices, rowIndices.size(), { 2 }, stats, 10);
+            success &= check(std::accumulate(histograms.begin(), histograms.end(), std::uint64_t{ 0 }) == rowIndices.size(), "histogram blocks add up to all selected rows");
+        }
+
+        return success;
+    }
+
+} // namespace Test
@@ -1,4 +1,5 @@
 #include <iostream>
+#include <string>
 
 #include <QString>
 
@@ -7,7 +8,9 @@
 #include <pybind11/subinterpreter.h>
 #define slots Q_SLOTS
 
+#include "AsyncTransfer.h"
 #include "PythonUtils.h"
+#include "SubinterpreterConfig.h"
 
 namespace py = pybind11;
 
@@ -20,8 +23,40 @@ PYBIND11_EMBEDDED_MODULE(my_module, m, py::multiple_interpreters::per_interprete
     m.attr("value") = 42;
 }
 
+// Does not declare subinterpreter support, so it can only be imported in the main interpreter
+PYBIND11_EMBEDDED_MODULE(single_interpreter_module, m) {
+    m.attr("value") = 1;
+}
+
+// Stands in for the module of the JupyterPlugin, mvstudio.data only needs it to be importable
+// The tests replace the functions they use, the futures of the asynchronous transfers are the plugin's
+PYBIND11_EMBEDDED_MODULE(mvstudio_core, m, py::multiple_interpreters::per_interpreter_gil()) {
+    struct DatasetHandle {};
+    py::class_<DatasetHandle>(m, "DatasetHandle");
+
+    m.attr("AsyncFuture") = create_async_future_type();
+}
+
 namespace Test {
-    void runPython();
+    bool runPython();
+    bool runDimensionStats();
+    bool runOutputCoalescer();
+    bool runScriptCache();
+    bool runRequirementsCacheKey();
+    bool runEnvironmentProbeKey();
+    bool runHierarchyIndex();
+    bool runDatasetHandle();
+    bool runPointChunks();
+    bool runPropertyConversion();
+    bool runAsyncTransfer();
+
+    bool run(const char* name, bool (*test)())
+    {
+        std::cout << " --- START::" << name << " --- " << std::endl;
+        const bool success = test();
+        std::cout << " --- FINISHED::" << name << (success ? "" : " (FAILED)") << " --- " << std::endl;
+        return success;
+    }
 }
 
 // Run with e.g. ./JupyterPluginTest.exe C:/Users/default/AppData/Local/miniconda3/envs/mv_13_run/python.exe
@@ -39,18 +74,47 @@ int main(int argc, char** argv) {
 
     setPythonEnv(pythonInterpreterPath, pythonVersion, "");
 
-    std::cout << " --- START::runPython --- " << std::endl;
-    Test::runPython();
-    std::cout << " --- FINISHED::runPython --- " << std::endl;
+    bool success = true;
+    success &= Test::run("runDimensionStats", Test::runDimensionStats);
+    success &= Test::run("runOutputCoalescer", Test::runOutputCoalescer);
+    success &= Test::run("runRequirementsCacheKey", Test::runRequirementsCacheKey);
+    success &= Test::run("runEnvironmentProbeKey", Test::runEnvironmentProbeKey);
 
-    return 0;
+    // the python tests share one interpreter
+    {
+        py::scoped_interpreter main_interpreter{};
+
+        success &= Test::run("runPython", Test::runPython);
+        success &= Test::run("runScriptCache", Test::runScriptCache);
+        success &= Test::run("runHierarchyIndex", Test::runHierarchyIndex);
+        success &= Test::run("runDatasetHandle", Test::runDatasetHandle);
+        success &= Test::run("runPointChunks", Test::runPointChunks);
+        success &= Test::run("runPropertyConversion", Test::runPropertyConversion);
+        success &= Test::run("runAsyncTransfer", Test::runAsyncTransfer);
+    }
+
+    return success ? 0 : 1;
 }
 
 namespace Test
 {
-    void runPython()
+    // Imports numpy and mvstudio.data in the current interpreter, returns the error or an empty string
+    std::string importDataModules()
     {
-        py::scoped_interpreter main_interpreter{};
+        try {
+            py::module_::import("sys").attr("path").attr("insert")(0, MVSTUDIO_DATA_DIR);
+            py::module_::import("numpy");
+            py::module_::import("mvstudio.data");
+            return {};
+        }
+        catch (const py::error_already_set& e) {
+            return e.what();
+        }
+    }
+
+    bool runPython()
+    {
+        bool success = true;
 
         // --- Main interpreter ---
         {
@@ -82,6 +146,48 @@ namespace Test
             // Still 100 - main interpreter was unaffected by the sub
             py::print("Main value after sub destroyed:", mod.attr("value"));
         }
+
+        // --- numpy and mvstudio.data ---
+        {
+            const std::string error = importDataModules();
+            py::print("Main imports numpy and mvstudio.data:", error.empty() ? "yes" : error);
+            success = success && error.empty();
+        }
+
+        // numpy does not support subinterpreters with their own GIL, so this is expected to fail
+        {
+            py::subinterpreter sub = py::subinterpreter::create();
+            py::subinterpreter_scoped_activate guard(sub);
+
+            const std::string error = importDataModules();
+            py::print("Own GIL subinterpreter imports numpy and mvstudio.data:", error.empty() ? "yes" : error);
+        }
+
+        // The additional kernels and scripts run in subinterpreters that share the GIL, which still check
+        // that extension modules support subinterpreters: numpy is expected to fail with an ImportError
+        {
+            py::subinterpreter sub = create_shared_gil_subinterpreter();
+            py::subinterpreter_scoped_activate guard(sub);
+
+            const std::string error = importDataModules();
+            py::print("Shared GIL subinterpreter imports numpy and mvstudio.data:", error.empty() ? "yes" : error);
+
+            const bool importsSupported = py::module_::import("my_module").attr("value").cast<int>() == 42;
+            py::print("Shared GIL subinterpreter imports a module that supports subinterpreters:", importsSupported ? "yes" : "no");
+            success = success && importsSupported;
+
+            bool refusesUnsupported = false;
+            try {
+                py::module_::import("single_interpreter_module");
+            }
+            catch (const py::error_already_set& e) {
+                refusesUnsupported = e.matches(PyExc_ImportError);
+            }
+            py::print("Shared GIL subinterpreter refuses a module that does not support subinterpreters:", refusesUnsupported ? "yes" : "no");
+            success = success && refusesUnsupported;
+        }
+
+        return success;
     }
 
 } // namespace TEST
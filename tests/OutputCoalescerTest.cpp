@@ -0,0 +1,144 @@
+#include <chrono>
+#include <iostream>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <utility>
+#include <vector>
+
+#include <nlohmann/json.hpp>
+
+#include "OutputCoalescer.h"
+
+namespace Test
+{
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        // Collects the published stream messages, serialized as json like the iopub messages of the kernel
+        struct Published
+        {
+            std::mutex                                          mutex;
+            std::vector<std::pair<std::string, std::string>>    messages;
+
+            OutputCoalescer::Publisher publisher()
+            {
+                return [this](const std::string& name, const std::string& text) {
+                    // dump throws for invalid UTF-8, as when the kernel serializes the message
+                    const std::string message = nlohmann::json({ { "name", name }, { "text", text } }).dump();
+                    std::scoped_lock lock(mutex);
+                    messages.emplace_back(name, text);
+                };
+            }
+
+            std::vector<std::pair<std::string, std::string>> take()
+            {
+                std::scoped_lock lock(mutex);
+                return std::exchange(messages, {});
+            }
+        };
+
+        void configure(OutputCoalescer& coalescer, std::uint64_t flushBytes, std::uint64_t flushIntervalMs, std::uint64_t maxCellBytes)
+        {
+            coalescer.settings().flushBytes         = flushBytes;
+            coalescer.settings().flushIntervalMs    = flushIntervalMs;
+            coalescer.settings().maxCellBytes       = maxCellBytes;
+        }
+    }
+
+    bool runOutputCoalescer()
+    {
+        bool success = true;
+
+        // "ab" followed by the 2 byte é and the 3 byte €
+        const std::string text = "ab\xc3\xa9\xe2\x82\xac";
+
+        // The longest prefix does not end within a multi-byte sequence
+        {
+            bool prefixes = true;
+            const std::vector<std::size_t> expected = { 0, 1, 2, 2, 4, 4, 4, 7, 7 };
+            for (std::size_t maxBytes = 0; maxBytes < expected.size(); ++maxBytes)
+                prefixes &= OutputCoalescer::utf8Prefix(text, maxBytes) == expected[maxBytes];
+
+            success &= check(prefixes, "utf8Prefix stops at code point boundaries");
+        }
+
+        // Output over the per cell limit is cut at a code point boundary and summarized at the end of the cell
+        {
+            Published published;
+            OutputCoalescer coalescer(published.publisher());
+            configure(coalescer, 1'000'000, 60'000, 6);
+
+            try {
+                coalescer.write("stdout", text);
+                coalescer.write("stdout", "dropped");
+                coalescer.endCell();
+            }
+            catch (const std::exception& e) {
+                std::cout << "  " << e.what() << "\n";
+            }
+
+            const auto messages = published.take();
+            // the € does not fit, of the next write the 2 bytes that are left do
+            success &= check(messages.size() == 2 && messages[0] == std::pair<std::string, std::string>{ "stdout", "ab\xc3\xa9" "dr" }, "truncated output ends before the split character");
+            success &= check(messages.size() == 2 && messages[1].first == "stderr" && messages[1].second.find("[8 bytes of output were dropped, the limit is 6 bytes per cell]") != std::string::npos, "dropped bytes are summarized");
+
+            coalescer.write("stdout", "123456");
+            coalescer.endCell();
+            success &= check(published.take() == std::vector<std::pair<std::string, std::string>>{ { "stdout", "123456" } }, "the limit applies per cell");
+        }
+
+        // Writes are coalesced until the buffer exceeds flushBytes, stream changes keep the order
+        {
+            Published published;
+            OutputCoalescer coalescer(published.publisher());
+            configure(coalescer, 8, 60'000, 0);
+
+            coalescer.write("stdout", "123");
+            coalescer.write("stdout", "456");
+            coalescer.write("stderr", "err");
+            coalescer.write("stdout", "78901234");
+            coalescer.endCell();
+
+            const std::vector<std::pair<std::string, std::string>> expected = { { "stdout", "123456" }, { "stderr", "err" }, { "stdout", "78901234" } };
+            success &= check(published.take() == expected, "output is coalesced per stream in order");
+        }
+
+        // Each coalescer has its own settings
+        {
+            Published published;
+            OutputCoalescer first(published.publisher()), second(published.publisher());
+            configure(first, 1, 60'000, 0);
+
+            success &= check(second.settings().flushBytes == 8'192 && first.settings().flushBytes == 1, "settings are per coalescer");
+        }
+
+        // A publisher that throws on the flusher thread does not end the process, later output is published
+        {
+            Published published;
+            bool failed = false;
+            OutputCoalescer coalescer([&failed, publish = published.publisher()](const std::string& name, const std::string& text) {
+                if (!std::exchange(failed, true))
+                    throw std::runtime_error("cannot publish");
+                publish(name, text);
+            });
+            configure(coalescer, 1'000'000, 10, 0);
+
+            coalescer.write("stdout", "lost");
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+            coalescer.write("stdout", "published");
+            std::this_thread::sleep_for(std::chrono::milliseconds(200));
+
+            success &= check(published.take() == std::vector<std::pair<std::string, std::string>>{ { "stdout", "published" } }, "the flusher survives a failing publisher");
+        }
+
+        return success;
+    }
+
+} // namespace Test
@@ -0,0 +1,118 @@
+#include <chrono>
+#include <filesystem>
+#include <iostream>
+
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QSet>
+#include <QString>
+#include <QTemporaryDir>
+#include <QVariantMap>
+
+#include "PythonUtils.h"
+
+namespace Test
+{
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        void writeFile(const QString& path, const QByteArray& content)
+        {
+            QFile file(path);
+            file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            file.write(content);
+        }
+
+        void setModified(const QString& path, const QDateTime& modified)
+        {
+            QFile file(path);
+            file.open(QIODevice::ReadWrite);
+            file.setFileTime(modified, QFileDevice::FileModificationTime);
+        }
+    }
+
+    bool runRequirementsCacheKey()
+    {
+        bool success = true;
+
+        QTemporaryDir directory;
+        const QString requirements  = directory.filePath("script_requirements.txt");
+        const QString copy          = directory.filePath("other_requirements.txt");
+        const QString interpreter   = "/envs/mv/bin/python";
+        constexpr qint64 modified   = 1'700'000'000'000;
+
+        writeFile(requirements, "numpy>=2\nscikit-image\n");
+        writeFile(copy, "numpy>=2\nscikit-image\n");
+
+        const QString key = requirementsCacheKey(requirements, interpreter, modified);
+
+        success &= check(key == requirementsCacheKey(requirements, interpreter, modified), "the key is stable");
+        success &= check(key == requirementsCacheKey(copy, interpreter, modified), "the key depends on the content of the requirements, not their location");
+        success &= check(key == requirementsCacheKey(requirements, "/envs/mv/bin/../bin/python", modified), "equivalent interpreter paths give the same key");
+
+        QSet<QString> otherKeys = {
+            requirementsCacheKey(requirements, "/envs/other/bin/python", modified),
+            requirementsCacheKey(requirements, interpreter, modified + 1),
+            requirementsCacheKey(directory.filePath("missing.txt"), interpreter, modified),
+        };
+
+        writeFile(requirements, "numpy>=2\nscikit-image\nscipy\n");
+        otherKeys.insert(requirementsCacheKey(requirements, interpreter, modified));
+
+        success &= check(!otherKeys.contains(key) && otherKeys.size() == 4, "the interpreter, installed packages and requirements each change the key");
+
+        return success;
+    }
+
+    bool runEnvironmentProbeKey()
+    {
+        bool success = true;
+
+        QTemporaryDir directory;
+        const QString interpreter   = directory.filePath("python");
+        const QString sitePackages  = directory.filePath("site-packages");
+        const QDateTime modified    = QDateTime::fromSecsSinceEpoch(1'700'000'000);
+
+        writeFile(interpreter, "#!python");
+        setModified(interpreter, modified);
+        QDir(directory.path()).mkdir("site-packages");
+
+        const QString stamp = fileStamp(interpreter);
+
+        success &= check(fileStamp(directory.filePath("missing")).isEmpty(), "a missing file has no stamp");
+        success &= check(!stamp.isEmpty() && stamp == fileStamp(interpreter), "the stamp is stable");
+        success &= check(stamp == fileStamp(directory.filePath("site-packages/../python")), "equivalent paths give the same stamp");
+
+        QVariantMap probe = {
+            { "interpreter", stamp },
+            { "mvstudio", "1.0" },
+            { "site-packages", fileStamp(sitePackages) },
+        };
+
+        success &= check(isEnvironmentProbeCurrent(probe, interpreter), "a probe of the same interpreter is used");
+        success &= check(!isEnvironmentProbeCurrent(probe, directory.filePath("missing")), "a probe is not used for a missing interpreter");
+        success &= check(isMvModulesProbeCurrent(probe, "1.0", sitePackages), "the module probe holds for the same plugin and packages");
+        success &= check(!isMvModulesProbeCurrent(probe, "1.1", sitePackages), "a plugin update probes the modules again");
+
+        // installing a package touches the directory
+        const std::filesystem::path sitePackagesDir = sitePackages.toStdString();
+        std::filesystem::last_write_time(sitePackagesDir, std::filesystem::last_write_time(sitePackagesDir) + std::chrono::minutes(1));
+        success &= check(!isMvModulesProbeCurrent(probe, "1.0", sitePackages), "installing packages probes the modules again");
+
+        setModified(interpreter, modified.addSecs(60));
+        success &= check(!isEnvironmentProbeCurrent(probe, interpreter), "an updated interpreter is probed again");
+
+        writeFile(interpreter, "#!python3");
+        setModified(interpreter, modified);
+        success &= check(!isEnvironmentProbeCurrent(probe, interpreter), "a replaced interpreter of another size is probed again");
+
+        return success;
+    }
+
+} // namespace Test
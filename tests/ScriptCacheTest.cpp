@@ -0,0 +1,91 @@
+#include <iostream>
+#include <string>
+
+#include <QByteArray>
+#include <QDateTime>
+#include <QDir>
+#include <QFile>
+#include <QTemporaryDir>
+
+#undef slots
+#include <pybind11/embed.h>
+#define slots Q_SLOTS
+
+#include "ScriptCache.h"
+
+namespace py = pybind11;
+
+namespace Test
+{
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        void writeScript(const QString& path, const QByteArray& content, const QDateTime& lastModified)
+        {
+            QFile file(path);
+            file.open(QIODevice::WriteOnly | QIODevice::Truncate);
+            file.write(content);
+            file.flush();   // writing later would change the modification time
+            file.setFileTime(lastModified, QFileDevice::FileModificationTime);
+        }
+
+        // Runs the cached code of the script and returns its global value
+        py::object runScript(const QString& path)
+        {
+            py::dict globals;
+            py::module_::import("builtins").attr("exec")(compileScript(path), globals);
+            return globals["value"];
+        }
+    }
+
+    // Needs the interpreter, see main
+    bool runScriptCache()
+    {
+        bool success = true;
+
+        QTemporaryDir directory;
+        const QString path          = directory.filePath("script.py");
+        const QDateTime modified    = QDateTime::currentDateTime().addSecs(-60);
+
+        try {
+            writeScript(path, "value = 1\n", modified);
+            success &= check(runScript(path).cast<int>() == 1, "a script is compiled");
+
+            // the cache key is the absolute path, an unchanged file of the same version is not read again
+            writeScript(path, "value = 2\n", modified);
+            success &= check(runScript(path).cast<int>() == 1, "an unchanged modification time and size use the cached code");
+
+            const QString currentPath = QDir::currentPath();
+            QDir::setCurrent(directory.path());
+            const bool relativeCached = runScript("script.py").cast<int>() == 1;
+            QDir::setCurrent(currentPath);
+            success &= check(relativeCached, "paths are made absolute for the key");
+
+            writeScript(path, "value = 3\n", modified.addSecs(1));
+            success &= check(runScript(path).cast<int>() == 3, "a new modification time compiles the script again");
+
+            writeScript(path, "value = 40\n", modified.addSecs(1));
+            success &= check(runScript(path).cast<int>() == 40, "a new size compiles the script again");
+
+            // the cached code is marshalled, it runs again after the first use
+            success &= check(runScript(path).cast<int>() == 40 && runScript(path).cast<int>() == 40, "cached code can be run repeatedly");
+
+            // compiled from bytes, the encoding declaration of the script applies
+            const QString latin1Path = directory.filePath("latin1.py");
+            writeScript(latin1Path, "# -*- coding: latin-1 -*-\nvalue = '\xe9'\n", modified);
+            success &= check(runScript(latin1Path).cast<std::string>() == "\xc3\xa9", "the encoding declaration is honored");
+        }
+        catch (const py::error_already_set& e) {
+            std::cout << "  " << e.what() << "\n";
+            success = false;
+        }
+
+        return success;
+    }
+
+} // namespace Test
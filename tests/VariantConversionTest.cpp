@@ -0,0 +1,89 @@
+#include <cstdint>
+#include <iostream>
+#include <string>
+
+#include <QPoint>
+#include <QString>
+#include <QVariant>
+
+#undef slots
+#include <pybind11/embed.h>
+#include <pybind11/numpy.h>
+#define slots Q_SLOTS
+
+#include "VariantConversion.h"
+
+namespace py = pybind11;
+
+namespace Test
+{
+    namespace
+    {
+        bool check(bool condition, const char* what)
+        {
+            std::cout << (condition ? "  ok:     " : "  FAILED: ") << what << "\n";
+            return condition;
+        }
+
+        // Whether the property converts to a numpy array of element type T with the values of the list
+        template<typename T>
+        bool isArrayOf(const QVariantList& list)
+        {
+            const py::object converted = property_to_pyobject(list);
+            if (!py::isinstance<py::array_t<T>>(converted))
+                return false;
+
+            const auto array = converted.cast<py::array_t<T>>();
+            if (array.ndim() != 1 || array.size() != list.size())
+                return false;
+
+            for (qsizetype i = 0; i < list.size(); ++i)
+                if (array.at(i) != list[i].value<T>())
+                    return false;
+
+            return true;
+        }
+    }
+
+    // Needs the interpreter, see main
+    bool runPropertyConversion()
+    {
+        bool success = true;
+
+        try {
+            py::module_::import("numpy");
+
+            QVariantList counts;
+            for (int i = 0; i < 10'000; ++i)
+                counts.append(i - 5'000);
+
+            success &= check(isArrayOf<std::int32_t>(counts), "a list of int becomes an int32 array");
+            success &= check(isArrayOf<std::uint64_t>({ QVariant::fromValue<qulonglong>(1), QVariant::fromValue<qulonglong>(~0ull) }), "a list of unsigned long long becomes a uint64 array");
+            success &= check(isArrayOf<float>({ 0.5f, -1.25f }), "a list of float becomes a float32 array");
+            success &= check(isArrayOf<double>({ 0.1, 1e300 }), "a list of double becomes a float64 array");
+            success &= check(isArrayOf<bool>({ true, false, true }), "a list of bool becomes a bool array");
+
+            // lists of mixed or non-numeric entries stay python lists
+            const py::object mixed = property_to_pyobject(QVariantList{ 1, 2.5 });
+            success &= check(py::isinstance<py::list>(mixed) && mixed.equal(py::eval("[1, 2.5]")), "a list of mixed numbers stays a list");
+
+            const py::object strings = property_to_pyobject(QVariantList{ QString("a"), QString("b") });
+            success &= check(py::isinstance<py::list>(strings) && strings.equal(py::eval("['a', 'b']")), "a list of strings stays a list");
+
+            const py::object empty = property_to_pyobject(QVariantList{});
+            success &= check(py::isinstance<py::list>(empty) && py::len(empty) == 0, "an empty list stays a list");
+
+            // single values
+            success &= check(property_to_pyobject(42).equal(py::int_(42)), "an int becomes an int");
+            success &= check(property_to_pyobject(QString("name")).equal(py::str("name")), "a string becomes a str");
+            success &= check(property_to_pyobject(QPoint(1, 2)).is_none(), "an unsupported type becomes None");
+        }
+        catch (const py::error_already_set& e) {
+            std::cout << "  " << e.what() << "\n";
+            success = false;
+        }
+
+        return success;
+    }
+
+} // namespace Test